@@ -0,0 +1,617 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: clustergenerator.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "qstat.h"
+#include "recordingbackend.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+
+/**
+ * @brief The ClusterGenerator class Writes the output of qstat, qstat -f -xml
+ * and qstat -xml -j for a made up cluster in the layout of qview --record, so
+ * it can be replayed with qview --replay. The hosts of the configured
+ * queues come first, so their jobs are classified as on a real cell
+ */
+class ClusterGenerator {
+public:
+  ClusterGenerator();
+
+  void setJobs(int nJobs);
+  void setHosts(int nHosts);
+  void setArrayFraction(double fraction);
+  void setMpiFraction(double fraction);
+  void setSeed(uint seed);
+
+  int write(QString directory);
+
+private:
+  /// A queue instance on one host
+  struct Host {
+    QString name;
+    int cores;
+    int used;
+    bool down;
+    QVector<int> tasks;
+  };
+
+  /// One line of the job listing, either a whole job or one array task
+  struct Task {
+    int job;
+    int taskNumber;
+    QString state;
+    int slots;
+    QVector<int> hosts;
+  };
+
+  /// A job as described by qstat -xml -j
+  struct Job {
+    int number;
+    QString name;
+    QString user;
+    QString queueName;
+    QDateTime time;
+    int slots;
+    int nTasks;
+    QVector<int> tasks;
+  };
+
+  void _makeHosts();
+  void _makeJobs();
+  int _findHosts(int nHosts, int slots, QVector<int> &hosts);
+  int _random(int n);
+
+  int _writeListing(QString filename);
+  int _writeHostListing(QString filename);
+  void _writeJobList(QXmlStreamWriter &output, const Task &task);
+  int _writeDetails(QString directory);
+
+  QString _listingLine(const Task &task);
+
+  /// Domain appended to every host name
+  const QString _domain = ".crc.nd.edu";
+
+  /// Name of the cluster queue every host belongs to
+  const QString _clusterQueue = "all.q";
+
+  /// Number of jobs in each qstat -xml -j document
+  const int _jobsPerDocument = 500;
+
+  /// Number of jobs to generate
+  int _mNumJobs;
+
+  /// Number of hosts to generate
+  int _mNumHosts;
+
+  /// Fraction of jobs that are array jobs
+  double _mArrayFraction;
+
+  /// Fraction of jobs that span several hosts
+  double _mMpiFraction;
+
+  /// Random seed
+  uint _mSeed;
+
+  /// Queue names a pending job may ask for
+  QStringList _mQueueNames;
+
+  /// Generated hosts
+  QVector<Host> _mHosts;
+
+  /// Generated jobs
+  QVector<Job> _mJobs;
+
+  /// Generated listing lines
+  QVector<Task> _mTasks;
+};
+
+/**
+ * @brief ClusterGenerator::ClusterGenerator Default constructor
+ */
+ClusterGenerator::ClusterGenerator() {
+  this->_mNumJobs = 10000;
+  this->_mNumHosts = 1000;
+  this->_mArrayFraction = 0.05;
+  this->_mMpiFraction = 0.1;
+  this->_mSeed = 1;
+}
+
+/**
+ * @brief ClusterGenerator::setJobs Sets the number of jobs
+ * @param nJobs number of jobs
+ */
+void ClusterGenerator::setJobs(int nJobs) { this->_mNumJobs = qMax(0, nJobs); }
+
+/**
+ * @brief ClusterGenerator::setHosts Sets the number of hosts
+ * @param nHosts number of hosts
+ */
+void ClusterGenerator::setHosts(int nHosts) {
+  this->_mNumHosts = qMax(1, nHosts);
+}
+
+/**
+ * @brief ClusterGenerator::setArrayFraction Sets the share of array jobs
+ * @param fraction fraction of all jobs
+ */
+void ClusterGenerator::setArrayFraction(double fraction) {
+  this->_mArrayFraction = qBound(0.0, fraction, 1.0);
+}
+
+/**
+ * @brief ClusterGenerator::setMpiFraction Sets the share of jobs spanning
+ * several hosts
+ * @param fraction fraction of all jobs
+ */
+void ClusterGenerator::setMpiFraction(double fraction) {
+  this->_mMpiFraction = qBound(0.0, fraction, 1.0);
+}
+
+/**
+ * @brief ClusterGenerator::setSeed Sets the random seed so runs repeat
+ * @param seed random seed
+ */
+void ClusterGenerator::setSeed(uint seed) { this->_mSeed = seed; }
+
+/**
+ * @brief ClusterGenerator::_random Returns a random number
+ * @param n upper bound
+ * @return number in [0, n)
+ */
+int ClusterGenerator::_random(int n) { return n <= 1 ? 0 : qrand() % n; }
+
+/**
+ * @brief ClusterGenerator::_makeHosts Builds the host list from the
+ * configured queues, then pads it with hosts no queue uses
+ */
+void ClusterGenerator::_makeHosts() {
+  Qstat qstat;
+  QSet<QString> seen;
+
+  this->_mHosts.clear();
+  this->_mQueueNames = QStringList() << this->_clusterQueue;
+
+  for (int i = 0; i < qstat.numQueues(); i++) {
+    Queue *queue = qstat.queue(i);
+    this->_mQueueNames << queue->queueName();
+    QVector<QPair<int, int> > ranges = queue->nodeRanges();
+    for (int j = 0; j < ranges.size(); j++) {
+      for (int node = ranges[j].first; node <= ranges[j].second; node++) {
+        Host host;
+        host.name = queue->nodeName() + QString("%1").arg(
+                                            node, queue->nameFormat(), 10,
+                                            QChar('0'));
+        if (seen.contains(host.name))
+          continue;
+        seen.insert(host.name);
+        host.cores = queue->coreSize();
+        this->_mHosts.push_back(host);
+      }
+    }
+  }
+
+  if (this->_mHosts.size() > this->_mNumHosts)
+    this->_mHosts.resize(this->_mNumHosts);
+  for (int i = this->_mHosts.size(); i < this->_mNumHosts; i++) {
+    Host host;
+    host.name = QString("compute%1").arg(i, 5, 10, QChar('0'));
+    host.cores = 24;
+    this->_mHosts.push_back(host);
+  }
+
+  for (int i = 0; i < this->_mHosts.size(); i++) {
+    this->_mHosts[i].used = 0;
+    this->_mHosts[i].down = this->_random(50) == 0;
+  }
+  return;
+}
+
+/**
+ * @brief ClusterGenerator::_findHosts Picks hosts with enough free slots
+ * @param nHosts number of distinct hosts wanted
+ * @param slots free slots needed on each host
+ * @param hosts filled with the chosen hosts
+ * @return status code, nonzero if the cluster is too full
+ */
+int ClusterGenerator::_findHosts(int nHosts, int slots, QVector<int> &hosts) {
+  hosts.clear();
+  for (int attempt = 0; attempt < 4 * nHosts + 8 && hosts.size() < nHosts;
+       attempt++) {
+    int h = this->_random(this->_mHosts.size());
+    const Host &host = this->_mHosts[h];
+    if (!host.down && host.cores - host.used >= slots && !hosts.contains(h))
+      hosts.push_back(h);
+  }
+  return hosts.size() == nHosts ? 0 : 1;
+}
+
+/**
+ * @brief ClusterGenerator::_makeJobs Builds the jobs. Most are single host
+ * jobs, some are MPI jobs using whole hosts and some are array jobs
+ * whose tasks run as separate listing lines
+ */
+void ClusterGenerator::_makeJobs() {
+  static const int singleSlots[] = {1, 4, 8, 12};
+  static const char *const pendingStates[] = {"qw", "qw", "qw", "qw",
+                                              "hqw", "Eqw"};
+  static const char *const runningStates[] = {"r", "r", "r", "r", "r",
+                                              "r", "t", "Rr", "dr", "s"};
+  QDateTime base(QDate(2017, 11, 14), QTime(9, 41, 27), Qt::UTC);
+  QVector<int> hosts;
+
+  this->_mJobs.clear();
+  this->_mTasks.clear();
+
+  for (int i = 0; i < this->_mNumJobs; i++) {
+    Job job;
+    job.number = 1000000 + i;
+    job.name = QString("job_%1").arg(i);
+    job.user = QString("user%1").arg(this->_random(200), 3, 10, QChar('0'));
+    job.queueName =
+        this->_mQueueNames[this->_random(this->_mQueueNames.size())];
+    job.time = base.addSecs(this->_random(86400 * 7));
+    job.nTasks = 0;
+
+    double kind = double(this->_random(1000)) / 1000.0;
+    bool run = this->_random(10) < 7;
+
+    if (kind < this->_mArrayFraction) {
+      //...Array job: some tasks run, the rest wait on one line
+      job.slots = 1;
+      job.nTasks = 2 + this->_random(20);
+      int nRunning = run ? 1 + this->_random(job.nTasks) : 0;
+      for (int t = 1; t <= nRunning; t++) {
+        if (this->_findHosts(1, 1, hosts) != 0) {
+          nRunning = t - 1;
+          break;
+        }
+        Task task;
+        task.job = this->_mJobs.size();
+        task.taskNumber = t;
+        task.state = runningStates[this->_random(10)];
+        task.slots = 1;
+        task.hosts = hosts;
+        job.tasks.push_back(this->_mTasks.size());
+        this->_mTasks.push_back(task);
+      }
+      if (nRunning < job.nTasks) {
+        Task task;
+        task.job = this->_mJobs.size();
+        task.taskNumber = -(nRunning + 1);
+        task.state = "qw";
+        task.slots = 1;
+        job.tasks.push_back(this->_mTasks.size());
+        this->_mTasks.push_back(task);
+      }
+    } else {
+      Task task;
+      task.job = this->_mJobs.size();
+      task.taskNumber = 0;
+      if (kind < this->_mArrayFraction + this->_mMpiFraction) {
+        //...MPI job spanning whole hosts
+        int nHosts = 2 + this->_random(7);
+        task.slots = 24;
+        job.slots = nHosts * task.slots;
+        if (run && this->_findHosts(nHosts, task.slots, hosts) == 0)
+          task.hosts = hosts;
+      } else {
+        task.slots = singleSlots[this->_random(4)];
+        job.slots = task.slots;
+        if (run && this->_findHosts(1, task.slots, hosts) == 0)
+          task.hosts = hosts;
+      }
+      if (task.hosts.isEmpty())
+        task.state = pendingStates[this->_random(6)];
+      else
+        task.state = runningStates[this->_random(10)];
+      job.tasks.push_back(this->_mTasks.size());
+      this->_mTasks.push_back(task);
+    }
+
+    //...Claim the slots of every running task
+    for (int t = 0; t < job.tasks.size(); t++) {
+      Task &task = this->_mTasks[job.tasks[t]];
+      for (int h = 0; h < task.hosts.size(); h++) {
+        this->_mHosts[task.hosts[h]].used += task.slots;
+        this->_mHosts[task.hosts[h]].tasks.push_back(job.tasks[t]);
+      }
+    }
+
+    this->_mJobs.push_back(job);
+  }
+  return;
+}
+
+/**
+ * @brief ClusterGenerator::_listingLine Formats a task as qstat -r prints it.
+ * Running tasks name the queue instance of their master host
+ * @param task task to format
+ * @return job line, without the queue column for pending tasks, followed by
+ * its request lines
+ */
+QString ClusterGenerator::_listingLine(const Task &task) {
+  const Job &job = this->_mJobs[task.job];
+  QString line =
+      QString("%1 %2 %3 %4 %5 %6 ")
+          .arg(job.number, 7)
+          .arg(0.5 + 0.0001 * this->_random(1000), 0, 'f', 5)
+          .arg(job.name.left(10), -10)
+          .arg(job.user.left(12), -12)
+          .arg(task.state, -5)
+          .arg(job.time.toString("MM/dd/yyyy hh:mm:ss"));
+  if (task.hosts.isEmpty())
+    line += QString(30, ' ');
+  else
+    line += QString("%1@%2%3")
+                .arg(this->_clusterQueue)
+                .arg(this->_mHosts[task.hosts.first()].name)
+                .arg(this->_domain)
+                .leftJustified(30);
+  line += QString(" %1 ").arg(job.slots, 5);
+  if (task.taskNumber > 0)
+    line += QString::number(task.taskNumber);
+  else if (task.taskNumber < 0)
+    line += QString("%1-%2:1").arg(-task.taskNumber).arg(job.nTasks);
+  line += "\n";
+
+  //...Requests as qstat -r prints them below the job
+  line += QString("       Full jobname:     %1\n").arg(job.name);
+  line += QString("       Hard requested queues: *%1\n").arg(job.queueName);
+  return line;
+}
+
+/**
+ * @brief ClusterGenerator::_writeListing Writes the qstat -r listing
+ * @param filename file to write
+ * @return status code
+ */
+int ClusterGenerator::_writeListing(QString filename) {
+  QFile file(filename);
+  if (!file.open(QIODevice::WriteOnly))
+    return 1;
+  QTextStream output(&file);
+  output << "job-ID  prior   name       user         state submit/start at  "
+            "   queue                          slots ja-task-ID \n";
+  output << QString(130, '-') << "\n";
+
+  //...Running tasks first, then pending ones, as qstat sorts them
+  for (int pass = 0; pass < 2; pass++)
+    for (int i = 0; i < this->_mTasks.size(); i++)
+      if (this->_mTasks[i].hosts.isEmpty() == (pass == 1))
+        output << this->_listingLine(this->_mTasks[i]);
+  return 0;
+}
+
+/**
+ * @brief ClusterGenerator::_writeHostListing Writes the qstat -f -xml
+ * listing, one queue instance per host with the tasks running there, then
+ * the pending jobs
+ * @param filename file to write
+ * @return status code
+ */
+int ClusterGenerator::_writeHostListing(QString filename) {
+  QFile file(filename);
+  if (!file.open(QIODevice::WriteOnly))
+    return 1;
+  QXmlStreamWriter output(&file);
+  output.setAutoFormatting(true);
+
+  output.writeStartDocument();
+  output.writeStartElement("job_info");
+  output.writeStartElement("queue_info");
+  for (int i = 0; i < this->_mHosts.size(); i++) {
+    const Host &host = this->_mHosts[i];
+    output.writeStartElement("Queue-List");
+    output.writeTextElement("name",
+                            this->_clusterQueue + "@" + host.name +
+                                this->_domain);
+    output.writeTextElement("qtype", "BIP");
+    output.writeTextElement("slots_used", QString::number(host.used));
+    output.writeTextElement("slots_resv", "0");
+    output.writeTextElement("slots_total", QString::number(host.cores));
+    output.writeTextElement(
+        "load_avg",
+        QString::number(host.used + 0.01 * this->_random(100), 'f', 5));
+    output.writeTextElement("arch", "lx-amd64");
+    if (host.down)
+      output.writeTextElement("state", "au");
+    for (int t = 0; t < host.tasks.size(); t++)
+      this->_writeJobList(output, this->_mTasks[host.tasks[t]]);
+    output.writeEndElement();
+  }
+  output.writeEndElement();
+
+  output.writeStartElement("job_info");
+  for (int i = 0; i < this->_mTasks.size(); i++)
+    if (this->_mTasks[i].hosts.isEmpty())
+      this->_writeJobList(output, this->_mTasks[i]);
+  output.writeEndElement();
+
+  output.writeEndElement();
+  output.writeEndDocument();
+  return 0;
+}
+
+/**
+ * @brief ClusterGenerator::_writeJobList Writes a task as a job_list element
+ * of qstat -f -xml
+ * @param output writer to add the element to
+ * @param task task to write
+ */
+void ClusterGenerator::_writeJobList(QXmlStreamWriter &output,
+                                     const Task &task) {
+  const Job &job = this->_mJobs[task.job];
+  bool running = !task.hosts.isEmpty();
+  output.writeStartElement("job_list");
+  output.writeAttribute("state", running ? "running" : "pending");
+  output.writeTextElement("JB_job_number", QString::number(job.number));
+  output.writeTextElement(
+      "JAT_prio", QString::number(0.5 + 0.0001 * this->_random(1000), 'f', 5));
+  output.writeTextElement("JB_name", job.name);
+  output.writeTextElement("JB_owner", job.user);
+  output.writeTextElement("state", task.state);
+  output.writeTextElement(running ? "JAT_start_time" : "JB_submission_time",
+                          job.time.toString(Qt::ISODate));
+  output.writeTextElement("slots", QString::number(job.slots));
+  if (task.taskNumber > 0)
+    output.writeTextElement("tasks", QString::number(task.taskNumber));
+  else if (task.taskNumber < 0)
+    output.writeTextElement(
+        "tasks", QString("%1-%2:1").arg(-task.taskNumber).arg(job.nTasks));
+  output.writeEndElement();
+  return;
+}
+
+/**
+ * @brief ClusterGenerator::_writeDetails Writes the qstat -xml -j documents
+ * and their index
+ * @param directory output directory
+ * @return status code
+ */
+int ClusterGenerator::_writeDetails(QString directory) {
+  QFile index(RecordingBackend::detailsIndexFile(directory));
+  if (!index.open(QIODevice::WriteOnly))
+    return 1;
+  QTextStream indexOutput(&index);
+
+  for (int first = 0, n = 1; first < this->_mJobs.size();
+       first += _jobsPerDocument, n++) {
+    QString name = QString("details-%1.xml").arg(n);
+    QFile file(directory + "/" + name);
+    if (!file.open(QIODevice::WriteOnly))
+      return 1;
+    QTextStream output(&file);
+    QStringList ids;
+
+    output << "<?xml version='1.0'?>\n<detailed_job_info>\n  <djob_info>\n";
+    int last = qMin(first + _jobsPerDocument, this->_mJobs.size());
+    for (int i = first; i < last; i++) {
+      const Job &job = this->_mJobs[i];
+      ids << QString::number(job.number);
+      output << "    <element>\n"
+             << "      <JB_job_number>" << job.number << "</JB_job_number>\n"
+             << "      <JB_job_name>" << job.name << "</JB_job_name>\n"
+             << "      <JB_owner>" << job.user << "</JB_owner>\n"
+             << "      <JB_hard_queue_list>\n        <destin_ident_list>\n"
+             << "          <QR_name>" << job.queueName << "</QR_name>\n"
+             << "        </destin_ident_list>\n      </JB_hard_queue_list>\n"
+             << "      <JB_pe>mpi-24</JB_pe>\n      <JB_pe_range>\n"
+             << "        <ranges>\n          <RN_min>" << job.slots
+             << "</RN_min>\n          <RN_max>" << job.slots
+             << "</RN_max>\n        </ranges>\n      </JB_pe_range>\n";
+
+      output << "      <JB_ja_tasks>\n";
+      for (int t = 0; t < job.tasks.size(); t++) {
+        const Task &task = this->_mTasks[job.tasks[t]];
+        if (task.hosts.isEmpty())
+          continue;
+        output << "        <ulong_sublist>\n          <JAT_task_number>"
+               << qMax(1, task.taskNumber) << "</JAT_task_number>\n"
+               << "          <JAT_granted_destin_identifier_list>\n";
+        for (int h = 0; h < task.hosts.size(); h++) {
+          QString host = this->_mHosts[task.hosts[h]].name + this->_domain;
+          output << "            <element>\n              <JG_qname>"
+                 << this->_clusterQueue << "@" << host << "</JG_qname>\n"
+                 << "              <JG_qhostname>" << host
+                 << "</JG_qhostname>\n              <JG_slots>" << task.slots
+                 << "</JG_slots>\n            </element>\n";
+        }
+        output << "          </JAT_granted_destin_identifier_list>\n"
+               << "        </ulong_sublist>\n";
+      }
+      output << "      </JB_ja_tasks>\n    </element>\n";
+    }
+    output << "  </djob_info>\n</detailed_job_info>\n";
+    indexOutput << name << " " << ids.join(",") << "\n";
+  }
+  return 0;
+}
+
+/**
+ * @brief ClusterGenerator::write Generates the cluster and writes it
+ * @param directory output directory
+ * @return status code
+ */
+int ClusterGenerator::write(QString directory) {
+  qsrand(this->_mSeed);
+  QDir().mkpath(directory);
+  this->_makeHosts();
+  this->_makeJobs();
+  if (this->_writeListing(RecordingBackend::jobsFile(directory)) != 0 ||
+      this->_writeHostListing(RecordingBackend::hostsFile(directory)) != 0 ||
+      this->_writeDetails(directory) != 0)
+    return 1;
+  return 0;
+}
+
+/**
+ * @brief main Writes a synthetic cluster to the directory on the command line
+ * @return exit code
+ */
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+  QCommandLineParser parser;
+
+  parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+  parser.setApplicationDescription(
+      "Writes qstat output for a synthetic cluster in the layout of "
+      "qview --record");
+  parser.addHelpOption();
+  parser.addPositionalArgument("directory", "Directory to write to");
+
+  QCommandLineOption jobsOption("jobs", "Number of jobs", "count", "10000");
+  parser.addOption(jobsOption);
+  QCommandLineOption hostsOption("hosts", "Number of hosts", "count", "1000");
+  parser.addOption(hostsOption);
+  QCommandLineOption arrayOption("array-fraction",
+                                 "Fraction of jobs that are array jobs",
+                                 "fraction", "0.05");
+  parser.addOption(arrayOption);
+  QCommandLineOption mpiOption("mpi-fraction",
+                               "Fraction of jobs that span several hosts",
+                               "fraction", "0.1");
+  parser.addOption(mpiOption);
+  QCommandLineOption seedOption("seed", "Random seed", "seed", "1");
+  parser.addOption(seedOption);
+
+  parser.process(a);
+  if (parser.positionalArguments().size() != 1)
+    parser.showHelp(1);
+
+  ClusterGenerator generator;
+  generator.setJobs(parser.value(jobsOption).toInt());
+  generator.setHosts(parser.value(hostsOption).toInt());
+  generator.setArrayFraction(parser.value(arrayOption).toDouble());
+  generator.setMpiFraction(parser.value(mpiOption).toDouble());
+  generator.setSeed(parser.value(seedOption).toUInt());
+
+  QString directory = parser.positionalArguments().first();
+  if (generator.write(directory) != 0) {
+    QTextStream(stderr) << "Unable to write to " << directory << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,387 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: microbenchmark.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "hosttable.h"
+#include "jobdetailparser.h"
+#include "qjob.h"
+#include "qstat.h"
+#include "recordingbackend.h"
+#include "tablerenderer.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <cstdlib>
+#include <cstring>
+
+/// Number of heap allocations made by the program so far
+static qint64 _allocations = 0;
+
+//...Qt containers allocate with malloc and realloc rather than new, so the
+//   C allocator itself is counted. glibc exports its own entry points for
+//   wrappers like these, elsewhere allocations are not counted
+#ifdef __GLIBC__
+/// Allocations are counted on this platform
+static const bool _countsAllocations = true;
+
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *p, std::size_t size);
+
+void *malloc(std::size_t size) noexcept {
+  _allocations++;
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept {
+  _allocations++;
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *p, std::size_t size) noexcept {
+  _allocations++;
+  return __libc_realloc(p, size);
+}
+}
+#else
+/// Allocations are counted on this platform
+static const bool _countsAllocations = false;
+#endif
+
+/**
+ * @brief The MicroBenchmark class Times the parsing and classification
+ * paths one at a time on a recording made with qview --record
+ */
+class MicroBenchmark {
+public:
+  explicit MicroBenchmark(QString directory);
+
+  int load();
+
+  void run();
+
+private:
+  template <typename Function>
+  void _measure(const char *name, qint64 nItems, Function function);
+
+  void _parseLines();
+  void _jobStatus();
+  void _jobDetails();
+  void _classify();
+  void _hostLines();
+  void _formatLines();
+
+  /// Number of times each path is repeated
+  static const int _repeat = 5;
+
+  /// Bytes of the host listing handed to the parser at once
+  static const int _chunkSize = 16384;
+
+  /// Directory holding the recording
+  QString _mDirectory;
+
+  /// Recorded job listing
+  QByteArray _mJobListing;
+
+  /// Recorded host listing
+  QByteArray _mHostListing;
+
+  /// Recorded job detail documents
+  QVector<QByteArray> _mDetails;
+
+  /// Start and length of every job line in the listing
+  QVector<QPair<int, int> > _mLines;
+
+  /// Jobs parsed from the listing
+  QVector<Qjob> _mJobs;
+
+  /// Qstat object supplying the configured queues
+  Qstat _mQstat;
+
+  /// Stream for the results
+  QTextStream _mOutput;
+};
+
+/**
+ * @brief MicroBenchmark::MicroBenchmark Constructor
+ * @param directory directory holding the recording
+ */
+MicroBenchmark::MicroBenchmark(QString directory) : _mOutput(stdout) {
+  this->_mDirectory = directory;
+  this->_mQstat.setUseCache(false);
+}
+
+/**
+ * @brief MicroBenchmark::load Reads the recording and splits the listing
+ * into lines
+ * @return status code
+ */
+int MicroBenchmark::load() {
+  QFile jobs(RecordingBackend::jobsFile(this->_mDirectory));
+  QFile hosts(RecordingBackend::hostsFile(this->_mDirectory));
+  if (!jobs.open(QIODevice::ReadOnly) || !hosts.open(QIODevice::ReadOnly))
+    return 1;
+  this->_mJobListing = jobs.readAll();
+  this->_mHostListing = hosts.readAll();
+
+  QStringList details =
+      QDir(this->_mDirectory).entryList(QStringList() << "details-*.xml");
+  for (int i = 0; i < details.size(); i++) {
+    QFile document(this->_mDirectory + "/" + details[i]);
+    if (document.open(QIODevice::ReadOnly))
+      this->_mDetails.push_back(document.readAll());
+  }
+
+  //...Skip the two header lines of the listing and the request
+  //   lines qstat -r prints below each job
+  const char *data = this->_mJobListing.constData();
+  int start = 0;
+  for (int lineNumber = 0; start < this->_mJobListing.size(); lineNumber++) {
+    int end = this->_mJobListing.indexOf('\n', start);
+    if (end < 0)
+      end = this->_mJobListing.size();
+    Qjob job;
+    if (lineNumber >= 2 && job.fromQueueLine(data + start, end - start) == 0) {
+      this->_mLines.push_back(QPair<int, int>(start, end - start));
+      this->_mJobs.push_back(job);
+    }
+    start = end + 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief MicroBenchmark::_measure Runs a path several times and prints the
+ * best time and the malloc, calloc and realloc calls per item
+ * @param name name printed with the result
+ * @param nItems number of items handled by one run
+ * @param function path to time
+ */
+template <typename Function>
+void MicroBenchmark::_measure(const char *name, qint64 nItems,
+                              Function function) {
+  QElapsedTimer timer;
+  qint64 best = -1;
+  qint64 allocations = 0;
+
+  if (nItems <= 0) {
+    this->_mOutput << QString("%1 no input\n").arg(name, -24);
+    return;
+  }
+
+  for (int i = 0; i < _repeat; i++) {
+    qint64 before = _allocations;
+    timer.start();
+    function();
+    qint64 elapsed = timer.nsecsElapsed();
+    allocations = _allocations - before;
+    if (best < 0 || elapsed < best)
+      best = elapsed;
+  }
+
+  QString perItem = "-";
+  if (_countsAllocations)
+    perItem = QString::number(double(allocations) / nItems, 'f', 2);
+
+  this->_mOutput << QString("%1 %2 ns/item %3 allocations/item\n")
+                        .arg(name, -24)
+                        .arg(double(best) / nItems, 10, 'f', 1)
+                        .arg(perItem, 8);
+  this->_mOutput.flush();
+  return;
+}
+
+/**
+ * @brief MicroBenchmark::_parseLines Times Qjob::fromQueueLine
+ */
+void MicroBenchmark::_parseLines() {
+  const char *data = this->_mJobListing.constData();
+  this->_measure("Qjob::fromQueueLine", this->_mLines.size(), [this, data]() {
+    Qjob job;
+    for (int i = 0; i < this->_mLines.size(); i++)
+      job.fromQueueLine(data + this->_mLines[i].first,
+                        this->_mLines[i].second);
+  });
+  return;
+}
+
+/**
+ * @brief MicroBenchmark::_jobStatus Times Qjob::statusFromCode on the state
+ * column of every line
+ */
+void MicroBenchmark::_jobStatus() {
+  QVector<QByteArray> states;
+  for (int i = 0; i < this->_mLines.size(); i++) {
+    QList<QByteArray> tokens =
+        this->_mJobListing.mid(this->_mLines[i].first, this->_mLines[i].second)
+            .simplified()
+            .split(' ');
+    if (tokens.size() > 4)
+      states.push_back(tokens[4]);
+  }
+
+  this->_measure("Qjob::statusFromCode", states.size(), [&states]() {
+    int sum = 0;
+    for (int i = 0; i < states.size(); i++)
+      sum += Qjob::statusFromCode(states[i].constData(), states[i].size());
+    if (sum < 0)
+      abort();
+  });
+  return;
+}
+
+/**
+ * @brief MicroBenchmark::_jobDetails Times the extraction of job details
+ * from the recorded qstat -xml -j documents
+ */
+void MicroBenchmark::_jobDetails() {
+  QMap<int, QVector<Qjob *> > jobMap;
+  for (int i = 0; i < this->_mJobs.size(); i++)
+    jobMap[this->_mJobs[i].jobNumber()].push_back(&this->_mJobs[i]);
+
+  //...The index splits host names as qview does, so the jobs get
+  //   the node sets they are classified by
+  QueueIndex *index = this->_mQstat.queueIndex();
+  int nJobs = 0;
+  for (int i = 0; i < this->_mDetails.size(); i++) {
+    JobDetailParser parser(&jobMap, index);
+    parser.addData(this->_mDetails[i]);
+    nJobs += parser.jobsParsed();
+  }
+
+  this->_measure("JobDetailParser", nJobs, [this, &jobMap, index]() {
+    for (int i = 0; i < this->_mDetails.size(); i++) {
+      JobDetailParser parser(&jobMap, index);
+      parser.addData(this->_mDetails[i]);
+    }
+  });
+  return;
+}
+
+/**
+ * @brief MicroBenchmark::_classify Times QueueIndex::queuesForJob, which
+ * Qstat::_findQueue calls to place every job in its queues
+ */
+void MicroBenchmark::_classify() {
+  QueueIndex *index = this->_mQstat.queueIndex();
+  this->_measure("QueueIndex::queuesForJob", this->_mJobs.size(),
+                 [this, index]() {
+                   int sum = 0;
+                   for (int i = 0; i < this->_mJobs.size(); i++)
+                     sum += index->queuesForJob(&this->_mJobs[i]).size();
+                   if (sum < 0)
+                     abort();
+                 });
+  return;
+}
+
+/**
+ * @brief MicroBenchmark::_hostLines Times the host refresh of a collection,
+ * with the qstat -f -xml host listing fed to the streaming parser in pieces
+ * as they arrive from the process, both from scratch and as a refresh in
+ * which no host has changed
+ */
+void MicroBenchmark::_hostLines() {
+  QVector<Queue *> queues;
+  for (int i = 0; i < this->_mQstat.numQueues(); i++)
+    queues.push_back(this->_mQstat.queue(i));
+
+  HostTable hosts(this->_mQstat.queueIndex());
+  HostTable *table = &hosts;
+  auto refresh = [this, table, queues]() {
+    HostStatusParser parser(
+        [table](const HostStatusParser::Instance &instance) {
+          table->setState(instance);
+        });
+    table->beginRefresh(queues);
+    for (int i = 0; i < this->_mHostListing.size(); i += _chunkSize)
+      parser.addData(this->_mHostListing.mid(i, _chunkSize));
+    table->endRefresh();
+  };
+
+  this->_measure("HostStatusParser (first)",
+                 this->_mHostListing.count("<Queue-List>"),
+                 [table, refresh]() {
+                   table->clear();
+                   refresh();
+                 });
+  this->_measure("HostStatusParser (refresh)",
+                 this->_mHostListing.count("<Queue-List>"), refresh);
+  return;
+}
+
+/**
+ * @brief MicroBenchmark::_formatLines Times the rendering of a table row
+ */
+void MicroBenchmark::_formatLines() {
+  TableRenderer renderer;
+  this->_measure("TableRenderer::appendJob", this->_mJobs.size(),
+                 [this, &renderer]() {
+                   renderer.clear();
+                   for (int i = 0; i < this->_mJobs.size(); i++)
+                     renderer.appendJob(&this->_mJobs[i]);
+                 });
+  return;
+}
+
+/**
+ * @brief MicroBenchmark::run Times every path
+ */
+void MicroBenchmark::run() {
+  this->_mOutput << "jobs: " << this->_mJobs.size()
+                 << "  detail documents: " << this->_mDetails.size()
+                 << "  queues: " << this->_mQstat.numQueues() << "\n";
+  this->_parseLines();
+  this->_jobStatus();
+  this->_jobDetails();
+  this->_classify();
+  this->_hostLines();
+  this->_formatLines();
+  return;
+}
+
+/**
+ * @brief main Runs the micro-benchmarks on the recording named on the
+ * command line
+ * @return exit code
+ */
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+
+  if (argc < 2) {
+    QTextStream(stderr) << "Usage: " << argv[0] << " <recording directory>\n"
+                        << "Record one with qview --record <directory>\n";
+    return 1;
+  }
+
+  MicroBenchmark benchmark(argv[1]);
+  if (benchmark.load() != 0) {
+    QTextStream(stderr) << "Unable to read a recording from " << argv[1]
+                        << "\n";
+    return 1;
+  }
+  benchmark.run();
+
+  return 0;
+}
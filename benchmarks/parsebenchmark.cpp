@@ -0,0 +1,150 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: parsebenchmark.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "qjob.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <cstring>
+
+/// Fields read by the original line parser
+struct LegacyJob {
+  int jobNumber;
+  qreal priority;
+  QString jobName;
+  QString user;
+  QString status;
+  QDateTime time;
+  QString node;
+  QString core;
+  int coreNumber;
+};
+
+/**
+ * @brief legacyFromQueueLine The queue line parser as it was before it was
+ * rewritten to work on the raw buffer, kept here as the baseline
+ * @param line text from the queue line
+ * @param job parsed fields
+ */
+static void legacyFromQueueLine(QString line, LegacyJob &job) {
+  int tempInt;
+  bool ok;
+
+  line = line.simplified();
+  QStringList lineData = line.split(" ");
+  job.jobNumber = lineData.value(0).toInt();
+  job.priority = lineData.value(1).toDouble();
+  job.jobName = lineData.value(2);
+  job.user = lineData.value(3);
+  job.status = lineData.value(4);
+  job.time = QDateTime::fromString(lineData.value(5), "mm/dd/yyyy hh:MM:ss");
+  job.time.setDate(QDate::fromString(lineData.value(5), "mm/dd/yyyy"));
+  job.time.setTime(QTime::fromString(lineData.value(6), "hh:MM:ss"));
+  job.time.setTimeSpec(Qt::UTC);
+  job.node = lineData.value(7);
+  job.node = job.node.split("@").value(1);
+  job.core = job.node.split(".").value(0);
+  tempInt = job.core.right(3).toInt(&ok);
+  job.coreNumber = ok ? tempInt : -1;
+  job.core = job.core.left(job.core.length() - 3);
+}
+
+/**
+ * @brief makeListing Builds a qstat listing with a mix of running and
+ * pending jobs
+ * @param nJobs number of job lines
+ * @return listing in the format printed by qstat
+ */
+static QByteArray makeListing(int nJobs) {
+  QByteArray listing;
+  listing.append("job-ID  prior   name       user         state submit/start "
+                 "at     queue                          slots ja-task-ID \n");
+  listing.append(QByteArray(130, '-') + "\n");
+  for (int i = 0; i < nJobs; i++) {
+    if (i % 3 == 0)
+      listing.append(QString("%1 0.50500 job_%2 user%3 qw 11/14/2017 "
+                             "09:41:27                                 24\n")
+                         .arg(1000000 + i)
+                         .arg(i)
+                         .arg(i % 50)
+                         .toUtf8());
+    else
+      listing.append(
+          QString("%1 0.55500 job_%2 user%3 r 11/14/2017 09:41:27 "
+                  "long@d12chas%4.crc.nd.edu 24\n")
+              .arg(1000000 + i)
+              .arg(i)
+              .arg(i % 50)
+              .arg(i % 500 + 1, 3, 10, QChar('0'))
+              .toUtf8());
+  }
+  return listing;
+}
+
+/**
+ * @brief main Times the original and the in-place queue line parsers
+ * @return exit code
+ */
+int main(int argc, char *argv[]) {
+  int nJobs = argc > 1 ? QString(argv[1]).toInt() : 50000;
+  QTextStream output(stdout);
+  QElapsedTimer timer;
+  qint64 checksum = 0;
+
+  QByteArray listing = makeListing(nJobs);
+
+  //...Original parser: whole buffer split into a QStringList first
+  timer.start();
+  QStringList lines = QString(listing).split("\n");
+  for (int i = 2; i < lines.size() - 1; i++) {
+    LegacyJob job;
+    legacyFromQueueLine(lines.at(i), job);
+    checksum += job.jobNumber;
+  }
+  qint64 legacy = timer.nsecsElapsed();
+
+  //...In-place parser working on the raw buffer
+  timer.start();
+  const char *line = listing.constData();
+  const char *end = line + listing.size();
+  for (int lineNumber = 0; line < end; lineNumber++) {
+    const char *eol =
+        static_cast<const char *>(memchr(line, '\n', end - line));
+    if (eol == nullptr)
+      eol = end;
+    if (lineNumber >= 2) {
+      Qjob job;
+      if (job.fromQueueLine(line, eol - line) == 0)
+        checksum -= job.jobNumber();
+    }
+    line = eol + 1;
+  }
+  qint64 inPlace = timer.nsecsElapsed();
+
+  output << "lines:            " << nJobs << "\n";
+  output << "legacy parser:    " << double(legacy) / nJobs << " ns/line\n";
+  output << "in-place parser:  " << double(inPlace) / nJobs << " ns/line\n";
+  output << "speedup:          " << double(legacy) / double(inPlace) << "x\n";
+  if (checksum != 0)
+    output << "warning: parsers disagree on job numbers\n";
+
+  return 0;
+}
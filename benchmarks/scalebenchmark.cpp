@@ -0,0 +1,138 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: scalebenchmark.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "profiler.h"
+#include "qstat.h"
+#include "replaybackend.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <cstdio>
+#include <malloc.h>
+#include <unistd.h>
+
+/**
+ * @brief heapInUse Returns the bytes of heap handed out and not yet freed.
+ * Unlike the resident set, this drops again once the buffers of a run are
+ * freed, so it shows what the run keeps
+ * @return bytes in use, or -1 if the C library cannot report it
+ */
+static qint64 heapInUse() {
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+  return qint64(mallinfo2().uordblks);
+#endif
+#endif
+  return -1;
+}
+
+/**
+ * @brief main Runs the whole Qstat::run pipeline against a recording, such
+ * as one written by qview_clustergenerator, and reports what it cost
+ * @return exit code
+ */
+int main(int argc, char *argv[]) {
+  QCoreApplication a(argc, argv);
+  QCommandLineParser parser;
+
+  parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+  parser.setApplicationDescription(
+      "Times a full qview run against a recorded or generated cluster");
+  parser.addHelpOption();
+  parser.addPositionalArgument("directory", "Recording to replay");
+
+  QCommandLineOption parallelOption(
+      "parallel", "Maximum number of scheduler calls at once", "count", "4");
+  parser.addOption(parallelOption);
+  QCommandLineOption latencyOption(
+      "latency", "Delay added to every scheduler call", "msec", "0");
+  parser.addOption(latencyOption);
+
+  parser.process(a);
+  if (parser.positionalArguments().size() != 1)
+    parser.showHelp(1);
+
+  QTextStream report(stderr);
+  QString directory = parser.positionalArguments().first();
+
+  ReplayBackend *backend = new ReplayBackend();
+  if (backend->load(directory) != 0) {
+    report << "Unable to read a recording from " << directory << "\n";
+    return 1;
+  }
+  backend->setLatency(parser.value(latencyOption).toInt());
+
+  Qstat qstat;
+  qstat.setUseCache(false);
+  qstat.setBackend(backend);
+  qstat.setMaxProcesses(parser.value(parallelOption).toInt());
+
+  //...Send the tables to a scratch file so their size can be
+  //   measured without the terminal slowing the run down
+  QTemporaryFile scratch;
+  if (!scratch.open()) {
+    report << "Unable to create a scratch file\n";
+    return 1;
+  }
+  fflush(stdout);
+  int savedStdout = dup(fileno(stdout));
+  dup2(scratch.handle(), fileno(stdout));
+
+  //...The recording is already in memory, so what the run adds on
+  //   top of it is the job store, the tables and the queue counters
+  qint64 residentBefore = Profiler::residentMemory();
+  qint64 heapBefore = heapInUse();
+
+  QElapsedTimer timer;
+  timer.start();
+  qstat.run(qstat.queue(0)->hash());
+  qint64 collected = timer.nsecsElapsed();
+
+  qint64 residentAfter = Profiler::residentMemory();
+  qint64 heapAfter = heapInUse();
+
+  for (int i = 1; i < qstat.numQueues(); i++)
+    qstat.display(qstat.queue(i)->hash());
+  fflush(stdout);
+  qint64 total = timer.nsecsElapsed();
+
+  dup2(savedStdout, fileno(stdout));
+  close(savedStdout);
+
+  report << "recording:         " << directory << "\n";
+  report << "wall time:         " << double(total) / 1.0e6 << " ms\n";
+  report << "  first queue:     " << double(collected) / 1.0e6 << " ms\n";
+  report << "scheduler calls:   " << backend->callCount() << "\n";
+  report << "jobs held:         " << qstat.numJobs() << "\n";
+  report << "resident growth:   " << residentAfter - residentBefore
+         << " kB\n";
+  if (heapBefore >= 0)
+    report << "heap kept by run:  " << (heapAfter - heapBefore) / 1024
+           << " kB\n";
+  report << "peak memory:       " << Profiler::peakMemory() << " kB\n";
+  report << "output bytes:      " << QFileInfo(scratch.fileName()).size()
+         << "\n";
+
+  return 0;
+}
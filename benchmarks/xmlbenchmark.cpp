@@ -0,0 +1,123 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: xmlbenchmark.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "jobdetailparser.h"
+#include "profiler.h"
+#include "qjob.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+
+/// Size of the pieces the document is handed to the parser in
+static const int _chunkSize = 65536;
+
+/// Text that opens a qstat -xml -j document
+static const char *_header =
+    "<?xml version='1.0'?>\n<detailed_job_info>\n<djob_info>\n";
+
+/// Text that closes a qstat -xml -j document
+static const char *_footer = "</djob_info>\n</detailed_job_info>\n";
+
+/**
+ * @brief makeRecord Builds the detail record of a running parallel job
+ * @param i index of the job
+ * @return xml for one job
+ */
+static QByteArray makeRecord(int i) {
+  QByteArray xml;
+  xml.append("<element>\n");
+  xml.append(
+      QString("<JB_job_number>%1</JB_job_number>\n").arg(1000000 + i).toUtf8());
+  xml.append(QString("<JB_job_name>job_%1</JB_job_name>\n").arg(i).toUtf8());
+  xml.append("<JB_hard_queue_list><QR_name>*long</QR_name>"
+             "</JB_hard_queue_list>\n");
+  xml.append("<JB_pe_range><RN_min>24</RN_min><RN_max>24</RN_max>"
+             "</JB_pe_range>\n");
+  xml.append("<JB_ja_tasks><ulong_sublist><JAT_task_list>\n");
+  for (int j = 0; j < 2; j++)
+    xml.append(QString("<PET_id>1.d12chas%1</PET_id>\n")
+                   .arg((i + j) % 500 + 1, 3, 10, QChar('0'))
+                   .toUtf8());
+  xml.append("</JAT_task_list></ulong_sublist></JB_ja_tasks>\n");
+  xml.append("</element>\n");
+  return xml;
+}
+
+/**
+ * @brief main Parses a large job detail document either in one piece, as the
+ * output used to be collected, or in chunks, as it arrives from the pipe.
+ * Run each mode in its own process so the peak memory can be compared
+ * @return exit code
+ */
+int main(int argc, char *argv[]) {
+  int nJobs = argc > 1 ? QString(argv[1]).toInt() : 100000;
+  bool chunked = argc > 2 && QString(argv[2]) == "chunked";
+  QTextStream output(stdout);
+  QElapsedTimer timer;
+  qint64 firstResult = -1;
+
+  QVector<Qjob> jobs(nJobs);
+  QMap<int, QVector<Qjob *> > jobMap;
+  for (int i = 0; i < nJobs; i++)
+    jobMap[1000000 + i].push_back(&jobs[i]);
+
+  qint64 baseline = Profiler::peakMemory();
+
+  //...In chunked mode the document is generated a piece at a
+  //   time so only one chunk is resident, as with a pipe
+  timer.start();
+  JobDetailParser parser(&jobMap);
+  if (chunked) {
+    QByteArray pending(_header);
+    for (int i = 0; i < nJobs; i++) {
+      pending.append(makeRecord(i));
+      if (pending.size() >= _chunkSize) {
+        parser.addData(pending);
+        pending.clear();
+        if (firstResult < 0 && parser.jobsParsed() > 0)
+          firstResult = timer.nsecsElapsed();
+      }
+    }
+    pending.append(_footer);
+    parser.addData(pending);
+  } else {
+    QByteArray document(_header);
+    for (int i = 0; i < nJobs; i++)
+      document.append(makeRecord(i));
+    document.append(_footer);
+    parser.addData(document);
+  }
+  if (firstResult < 0 && parser.jobsParsed() > 0)
+    firstResult = timer.nsecsElapsed();
+  qint64 total = timer.nsecsElapsed();
+
+  output << "mode:                 " << (chunked ? "chunked" : "whole")
+         << "\n";
+  output << "jobs:                 " << parser.jobsParsed() << "\n";
+  output << "time to first result: " << double(firstResult) / 1.0e6
+         << " ms\n";
+  output << "total time:           " << double(total) / 1.0e6 << " ms\n";
+  output << "peak memory:          " << Profiler::peakMemory() - baseline
+         << " kB\n";
+  if (parser.hasError())
+    output << "warning: the document could not be parsed\n";
+
+  return 0;
+}
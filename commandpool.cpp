@@ -0,0 +1,266 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: commandpool.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "commandpool.h"
+#include <QEventLoop>
+
+/**
+ * @brief CommandPool::CommandPool Default constructor
+ * @param maxProcesses Maximum number of processes allowed to run at once
+ * @param parent Pointer to parent object
+ */
+CommandPool::CommandPool(int maxProcesses, QObject *parent) : QObject(parent) {
+  this->_mMaxProcesses = maxProcesses < 1 ? 1 : maxProcesses;
+  this->_mTimeout = 0;
+  this->_mEnvironment = QProcessEnvironment::systemEnvironment();
+  this->_mEnvironment.insert("IFS", "");
+}
+
+/**
+ * @brief CommandPool::maxProcesses Returns the maximum number of processes
+ * allowed to run at once
+ * @return maximum number of processes
+ */
+int CommandPool::maxProcesses() { return this->_mMaxProcesses; }
+
+/**
+ * @brief CommandPool::setMaxProcesses Sets the maximum number of processes
+ * allowed to run at once
+ * @param maxProcesses maximum number of processes
+ */
+void CommandPool::setMaxProcesses(int maxProcesses) {
+  this->_mMaxProcesses = maxProcesses < 1 ? 1 : maxProcesses;
+  this->_startNext();
+  return;
+}
+
+/**
+ * @brief CommandPool::timeout Returns the time a command may run before it
+ * is killed
+ * @return time in milliseconds, 0 if commands are never killed
+ */
+int CommandPool::timeout() { return this->_mTimeout; }
+
+/**
+ * @brief CommandPool::setTimeout Sets the time a command may run before it is
+ * killed. A killed command reports TimedOut along with whatever output it
+ * wrote first. Applies to commands started from now on
+ * @param msec time in milliseconds, 0 to never kill a command
+ */
+void CommandPool::setTimeout(int msec) {
+  this->_mTimeout = msec < 0 ? 0 : msec;
+  return;
+}
+
+/**
+ * @brief CommandPool::cancel Drops every queued command and kills every
+ * running one. Each callback is still called, with TimedOut, so callers see
+ * every command they submitted finish
+ */
+void CommandPool::cancel() {
+  QQueue<Request> pending;
+  pending.swap(this->_mPending);
+
+  for (int i = 0; i < pending.size(); i++)
+    if (pending[i].callback)
+      pending[i].callback(TimedOut, QByteArray());
+
+  QList<QProcess *> running = this->_mRunning.keys();
+  for (int i = 0; i < running.size(); i++) {
+    running[i]->kill();
+    this->_complete(running[i], TimedOut);
+  }
+
+  //...With nothing running, no completion announced it
+  if (running.isEmpty() && !pending.isEmpty() && this->isIdle())
+    emit idle();
+
+  return;
+}
+
+/**
+ * @brief CommandPool::isIdle Checks if there is no running or queued work
+ * @return true if the pool is idle
+ */
+bool CommandPool::isIdle() {
+  return this->_mPending.isEmpty() && this->_mRunning.isEmpty();
+}
+
+/**
+ * @brief CommandPool::submit Queues a command to be run. The callback is
+ * called from the event loop once the command has finished
+ * @param cmd command to run
+ * @param callback function called with the exit code and standard output
+ */
+void CommandPool::submit(QString cmd, Callback callback) {
+  this->submit(cmd, DataCallback(), callback);
+  return;
+}
+
+/**
+ * @brief CommandPool::submit Queues a command whose output is handed to the
+ * caller as it arrives instead of being collected. The completion callback
+ * then receives an empty output
+ * @param cmd command to run
+ * @param dataCallback function called with each piece of standard output
+ * @param callback function called with the exit code
+ */
+void CommandPool::submit(QString cmd, DataCallback dataCallback,
+                         Callback callback) {
+  Request request;
+  request.command = cmd;
+  request.callback = callback;
+  request.dataCallback = dataCallback;
+  this->_mPending.enqueue(request);
+  this->_startNext();
+  return;
+}
+
+/**
+ * @brief CommandPool::waitForFinished Runs an event loop until all queued and
+ * running commands, including any submitted from callbacks, have finished
+ */
+void CommandPool::waitForFinished() {
+  if (this->isIdle())
+    return;
+  QEventLoop loop;
+  connect(this, SIGNAL(idle()), &loop, SLOT(quit()));
+  loop.exec();
+  return;
+}
+
+/**
+ * @brief CommandPool::_startNext Starts queued commands while there are free
+ * process slots
+ */
+void CommandPool::_startNext() {
+  while (!this->_mPending.isEmpty() &&
+         this->_mRunning.size() < this->_mMaxProcesses) {
+    Request request = this->_mPending.dequeue();
+    QProcess *process = new QProcess(this);
+    process->setProcessEnvironment(this->_mEnvironment);
+    this->_mRunning[process] = request;
+    connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), this,
+            SLOT(_processFinished(int, QProcess::ExitStatus)));
+    connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)), this,
+            SLOT(_processError(QProcess::ProcessError)));
+    if (request.dataCallback)
+      connect(process, SIGNAL(readyReadStandardOutput()), this,
+              SLOT(_readyRead()));
+    if (this->_mTimeout > 0) {
+      //...The timer belongs to the process and goes away with it
+      QTimer *timer = new QTimer(process);
+      timer->setSingleShot(true);
+      connect(timer, SIGNAL(timeout()), this, SLOT(_processTimedOut()));
+      timer->start(this->_mTimeout);
+    }
+    process->start(request.command);
+  }
+  return;
+}
+
+/**
+ * @brief CommandPool::_processFinished Handles a process that has exited
+ * @param exitCode exit code of the process
+ * @param exitStatus exit status of the process
+ */
+void CommandPool::_processFinished(int exitCode,
+                                   QProcess::ExitStatus exitStatus) {
+  QProcess *process = qobject_cast<QProcess *>(this->sender());
+  if (exitStatus == QProcess::CrashExit)
+    exitCode = -1;
+  this->_complete(process, exitCode);
+  return;
+}
+
+/**
+ * @brief CommandPool::_processError Handles a process that could not be
+ * started. Other errors are followed by finished() and handled there
+ * @param error error code
+ */
+void CommandPool::_processError(QProcess::ProcessError error) {
+  if (error != QProcess::FailedToStart)
+    return;
+  QProcess *process = qobject_cast<QProcess *>(this->sender());
+  this->_complete(process, -1);
+  return;
+}
+
+/**
+ * @brief CommandPool::_readyRead Passes output from a streaming command to
+ * its caller as soon as it is available
+ */
+void CommandPool::_readyRead() {
+  QProcess *process = qobject_cast<QProcess *>(this->sender());
+  if (process == nullptr || !this->_mRunning.contains(process))
+    return;
+  QByteArray data = process->readAllStandardOutput();
+  if (!data.isEmpty() && this->_mRunning[process].dataCallback)
+    this->_mRunning[process].dataCallback(data);
+  return;
+}
+
+/**
+ * @brief CommandPool::_processTimedOut Kills a process that has run past the
+ * timeout and reports it with the output it has written so far
+ */
+void CommandPool::_processTimedOut() {
+  QProcess *process = qobject_cast<QProcess *>(this->sender()->parent());
+  if (process == nullptr || !this->_mRunning.contains(process))
+    return;
+  process->kill();
+  this->_complete(process, TimedOut);
+  return;
+}
+
+/**
+ * @brief CommandPool::_complete Runs the callback for a finished process and
+ * starts the next queued command
+ * @param process process that has finished
+ * @param exitCode exit code to report to the caller
+ */
+void CommandPool::_complete(QProcess *process, int exitCode) {
+  if (process == nullptr || !this->_mRunning.contains(process))
+    return;
+
+  Request request = this->_mRunning.take(process);
+  QByteArray output = process->readAllStandardOutput();
+  process->deleteLater();
+
+  //...Hand any output left in the pipe to a streaming caller
+  if (request.dataCallback) {
+    if (!output.isEmpty())
+      request.dataCallback(output);
+    output.clear();
+  }
+
+  //...Start the next command before parsing so the scheduler
+  //   is kept busy while this output is processed
+  this->_startNext();
+
+  if (request.callback)
+    request.callback(exitCode, output);
+
+  if (this->isIdle())
+    emit idle();
+
+  return;
+}
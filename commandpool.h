@@ -0,0 +1,101 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: commandpool.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef COMMANDPOOL_H
+#define COMMANDPOOL_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QQueue>
+#include <QTimer>
+#include <functional>
+
+class CommandPool : public QObject {
+  Q_OBJECT
+public:
+  /// Function called with the exit code and standard output of a command
+  typedef std::function<void(int exitCode, QByteArray output)> Callback;
+
+  /// Function called with each piece of standard output as it arrives
+  typedef std::function<void(QByteArray data)> DataCallback;
+
+  /// Exit code reported for a command that was stopped at its deadline
+  enum { TimedOut = -2 };
+
+  explicit CommandPool(int maxProcesses = 4, QObject *parent = nullptr);
+
+  void submit(QString cmd, Callback callback);
+
+  void submit(QString cmd, DataCallback dataCallback, Callback callback);
+
+  void waitForFinished();
+
+  bool isIdle();
+
+  int maxProcesses();
+
+  void setMaxProcesses(int maxProcesses);
+
+  int timeout();
+
+  void setTimeout(int msec);
+
+  void cancel();
+
+signals:
+  void idle();
+
+private slots:
+  void _processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+  void _processError(QProcess::ProcessError error);
+  void _readyRead();
+  void _processTimedOut();
+
+private:
+  /// A command waiting for a free process slot
+  struct Request {
+    QString command;
+    Callback callback;
+    DataCallback dataCallback;
+  };
+
+  void _startNext();
+  void _complete(QProcess *process, int exitCode);
+
+  /// Commands that have not been started yet
+  QQueue<Request> _mPending;
+
+  /// Commands that are currently running
+  QMap<QProcess *, Request> _mRunning;
+
+  /// Maximum number of processes that may run at once
+  int _mMaxProcesses;
+
+  /// Time a command may run before it is killed in milliseconds, 0 for none
+  int _mTimeout;
+
+  /// Environment used for all processes
+  QProcessEnvironment _mEnvironment;
+};
+
+#endif // COMMANDPOOL_H
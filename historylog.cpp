@@ -0,0 +1,327 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: historylog.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "historylog.h"
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <cstring>
+
+/**
+ * @brief HistoryLog::HistoryLog Constructor. The log keeps one append only
+ * file per day (UTC), each a file header followed by snapshots of fixed
+ * size records that can be read in place from a memory map
+ * @param directory directory holding the log files
+ * @param parent Pointer to parent object
+ */
+HistoryLog::HistoryLog(QString directory, QObject *parent) : QObject(parent) {
+  static_assert(sizeof(FileHeader) == 8, "unexpected log layout");
+  static_assert(sizeof(SnapshotHeader) == 24, "unexpected log layout");
+  static_assert(sizeof(QueueRecord) == 52, "unexpected log layout");
+  static_assert(sizeof(JobRecord) == 48, "unexpected log layout");
+  this->_mDirectory = directory;
+}
+
+/**
+ * @brief HistoryLog::defaultDirectory Returns the default location of the
+ * log, $XDG_DATA_HOME/qview/history
+ * @return path to the directory
+ */
+QString HistoryLog::defaultDirectory() {
+  return QStandardPaths::writableLocation(
+             QStandardPaths::GenericDataLocation) +
+         "/qview/history";
+}
+
+/**
+ * @brief HistoryLog::filename Returns the log file for a day
+ * @param day day in UTC
+ * @return path to the file
+ */
+QString HistoryLog::filename(QDate day) {
+  return this->_mDirectory + "/" + day.toString("yyyy-MM-dd") + ".qvh";
+}
+
+/**
+ * @brief HistoryLog::append Adds a snapshot of the queues and their jobs to
+ * the log for the day it was taken. The snapshot is written with a single
+ * call so a reader never sees half of one unless the writer dies
+ * @param time time the snapshot was taken
+ * @param queues every queue with its health counters
+ * @param jobs jobs in any of the queues
+ * @return status code
+ */
+int HistoryLog::append(QDateTime time, const QVector<Queue *> &queues,
+                       const QVector<Qjob *> &jobs) {
+  QString name = this->filename(time.toUTC().date());
+  QDir().mkpath(this->_mDirectory);
+
+  QFile file(name);
+  if (!file.open(QIODevice::ReadWrite | QIODevice::Append)) {
+    QTextStream(stderr) << "Unable to write history to " << name << "\n";
+    return 1;
+  }
+
+  //...Never append to a file written with a different layout
+  if (file.size() == 0) {
+    FileHeader header;
+    header.magic = _magic;
+    header.version = _version;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  } else {
+    FileHeader header;
+    file.seek(0);
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) !=
+            qint64(sizeof(header)) ||
+        header.magic != _magic || header.version != _version) {
+      QTextStream(stderr) << name << ": not a version " << _version
+                          << " history log\n";
+      return 1;
+    }
+  }
+
+  int nQueues = queues.size();
+  SnapshotHeader snapshot;
+  snapshot.magic = _snapshotMagic;
+  snapshot.size = sizeof(SnapshotHeader) + nQueues * sizeof(QueueRecord) +
+                  jobs.size() * sizeof(JobRecord);
+  snapshot.time = time.toMSecsSinceEpoch();
+  snapshot.nQueues = nQueues;
+  snapshot.nJobs = jobs.size();
+
+  QByteArray buffer(snapshot.size, '\0');
+  char *p = buffer.data();
+  memcpy(p, &snapshot, sizeof(snapshot));
+  p += sizeof(snapshot);
+
+  QVector<QByteArray> hashes(nQueues);
+  QVector<int> jobCounts(nQueues, 0);
+  for (int i = 0; i < nQueues; i++)
+    hashes[i] = queues[i]->hash();
+
+  QVector<JobRecord> jobRecords(jobs.size());
+  for (int i = 0; i < jobs.size(); i++) {
+    JobRecord &record = jobRecords[i];
+    QByteArray user = jobs[i]->user().toUtf8();
+    memset(&record, 0, sizeof(record));
+    record.jobNumber = jobs[i]->jobNumber();
+    record.status = jobs[i]->status();
+    record.ncpu = jobs[i]->ncpu();
+    record.time = jobs[i]->time().toMSecsSinceEpoch();
+    memcpy(record.user, user.constData(),
+           qMin(user.size(), int(sizeof(record.user))));
+    for (int j = 0; j < nQueues; j++) {
+      if (!jobs[i]->containsQueueHash(hashes[j]))
+        continue;
+      jobCounts[j]++;
+      if (j < 64)
+        record.queues |= quint64(1) << j;
+    }
+  }
+
+  for (int i = 0; i < nQueues; i++) {
+    QueueRecord record;
+    QByteArray hash = QByteArray::fromHex(hashes[i]);
+    memset(&record, 0, sizeof(record));
+    memcpy(record.hash, hash.constData(),
+           qMin(hash.size(), int(sizeof(record.hash))));
+    record.totalCores = queues[i]->queueTotalCores();
+    record.freeCores = queues[i]->queueFreeCores();
+    record.runningCores = queues[i]->queueRunningCores();
+    record.totalNodes = queues[i]->queueTotalNodes();
+    record.upNodes = queues[i]->queueUpNodes();
+    record.downNodes = queues[i]->queueDownNodes();
+    record.idleNodes = queues[i]->queueIdleNodes();
+    record.jobs = jobCounts[i];
+    memcpy(p, &record, sizeof(record));
+    p += sizeof(record);
+  }
+
+  if (!jobRecords.isEmpty())
+    memcpy(p, jobRecords.constData(), jobRecords.size() * sizeof(JobRecord));
+
+  if (file.write(buffer) != buffer.size()) {
+    QTextStream(stderr) << "Unable to write history to " << name << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief HistoryLog::query Averages the queue counters over fixed intervals.
+ * Only the log files for the days in the range are opened, and each is read
+ * through a memory map without copying it
+ * @param from start of the range
+ * @param to end of the range, not included
+ * @param interval length of each interval in seconds. Intervals start at
+ * whole multiples of the length since the epoch
+ * @param usage average state of each queue in each interval, ordered by time
+ * @return status code
+ */
+int HistoryLog::query(QDateTime from, QDateTime to, int interval,
+                      QVector<Usage> &usage) {
+  Buckets buckets;
+  qint64 intervalMsec = qint64(qMax(interval, 1)) * 1000;
+
+  usage.clear();
+  for (QDate day = from.toUTC().date(); day <= to.toUTC().date();
+       day = day.addDays(1))
+    this->_scan(this->filename(day), from.toMSecsSinceEpoch(),
+                to.toMSecsSinceEpoch(), intervalMsec, buckets);
+
+  for (Buckets::const_iterator it = buckets.constBegin();
+       it != buckets.constEnd(); ++it) {
+    for (QMap<QByteArray, Usage>::const_iterator q = it.value().constBegin();
+         q != it.value().constEnd(); ++q) {
+      Usage u = q.value();
+      double n = u.samples;
+      u.totalCores /= n;
+      u.freeCores /= n;
+      u.runningCores /= n;
+      u.totalNodes /= n;
+      u.upNodes /= n;
+      u.downNodes /= n;
+      u.idleNodes /= n;
+      u.runningJobs /= n;
+      u.pendingJobs /= n;
+      usage.push_back(u);
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief HistoryLog::_scan Adds every snapshot of one log file that is in
+ * the range to the intervals. A snapshot cut short by a crash ends the file
+ * @param filename log file to read
+ * @param from start of the range in milliseconds since the epoch
+ * @param to end of the range in milliseconds since the epoch
+ * @param interval length of each interval in milliseconds
+ * @param buckets running totals for each interval and queue
+ * @return status code
+ */
+int HistoryLog::_scan(QString filename, qint64 from, qint64 to,
+                      qint64 interval, Buckets &buckets) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly))
+    return 1;
+
+  qint64 size = file.size();
+  if (size < qint64(sizeof(FileHeader)))
+    return 1;
+
+  const uchar *data = file.map(0, size);
+  if (data == nullptr)
+    return 1;
+
+  FileHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (header.magic != _magic || header.version != _version) {
+    QTextStream(stderr) << filename << ": not a version " << _version
+                        << " history log\n";
+    file.unmap(const_cast<uchar *>(data));
+    return 1;
+  }
+
+  qint64 offset = sizeof(FileHeader);
+  while (offset + qint64(sizeof(SnapshotHeader)) <= size) {
+    SnapshotHeader snapshot;
+    memcpy(&snapshot, data + offset, sizeof(snapshot));
+
+    qint64 expected = sizeof(SnapshotHeader) +
+                      qint64(snapshot.nQueues) * sizeof(QueueRecord) +
+                      qint64(snapshot.nJobs) * sizeof(JobRecord);
+    if (snapshot.magic != _snapshotMagic || snapshot.size != expected ||
+        offset + expected > size)
+      break;
+
+    if (snapshot.time >= from && snapshot.time < to)
+      this->_add(data + offset, snapshot, interval, buckets);
+
+    offset += expected;
+  }
+
+  file.unmap(const_cast<uchar *>(data));
+  return 0;
+}
+
+/**
+ * @brief HistoryLog::_add Adds one snapshot to the running totals of the
+ * interval it falls in
+ * @param snapshot start of the snapshot in the memory map
+ * @param header header of the snapshot
+ * @param interval length of each interval in milliseconds
+ * @param buckets running totals for each interval and queue
+ */
+void HistoryLog::_add(const uchar *snapshot, const SnapshotHeader &header,
+                      qint64 interval, Buckets &buckets) {
+  const uchar *queueData = snapshot + sizeof(SnapshotHeader);
+  const uchar *jobData = queueData + header.nQueues * sizeof(QueueRecord);
+  qint64 start = header.time - header.time % interval;
+  QMap<QByteArray, Usage> &bucket = buckets[start];
+
+  //...Count running and pending jobs for each queue record
+  QVector<int> running(header.nQueues, 0), pending(header.nQueues, 0);
+  for (quint32 i = 0; i < header.nJobs; i++) {
+    JobRecord job;
+    memcpy(&job, jobData + i * sizeof(JobRecord), sizeof(job));
+    for (quint32 j = 0; j < header.nQueues && j < 64; j++) {
+      if ((job.queues & (quint64(1) << j)) == 0)
+        continue;
+      if (job.status == Qjob::SGE_STATUS_RUNNING)
+        running[j]++;
+      else if (job.status == Qjob::SGE_STATUS_PENDING)
+        pending[j]++;
+    }
+  }
+
+  for (quint32 i = 0; i < header.nQueues; i++) {
+    QueueRecord queue;
+    memcpy(&queue, queueData + i * sizeof(QueueRecord), sizeof(queue));
+    QByteArray hash = QByteArray(queue.hash, sizeof(queue.hash)).toHex();
+
+    if (!bucket.contains(hash)) {
+      Usage empty;
+      empty.start = QDateTime::fromMSecsSinceEpoch(start);
+      empty.hash = hash;
+      empty.samples = 0;
+      empty.totalCores = empty.freeCores = empty.runningCores = 0;
+      empty.totalNodes = empty.upNodes = empty.downNodes = 0;
+      empty.idleNodes = empty.runningJobs = empty.pendingJobs = 0;
+      bucket[hash] = empty;
+    }
+
+    Usage &u = bucket[hash];
+    u.samples++;
+    u.totalCores += queue.totalCores;
+    u.freeCores += queue.freeCores;
+    u.runningCores += queue.runningCores;
+    u.totalNodes += queue.totalNodes;
+    u.upNodes += queue.upNodes;
+    u.downNodes += queue.downNodes;
+    u.idleNodes += queue.idleNodes;
+    u.runningJobs += running[i];
+    u.pendingJobs += pending[i];
+  }
+  return;
+}
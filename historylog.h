@@ -0,0 +1,128 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: historylog.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef HISTORYLOG_H
+#define HISTORYLOG_H
+
+#include "qjob.h"
+#include "queue.h"
+#include <QByteArray>
+#include <QDate>
+#include <QDateTime>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class HistoryLog : public QObject {
+  Q_OBJECT
+public:
+  /// Average state of one queue over one interval
+  struct Usage {
+    QDateTime start;
+    QByteArray hash;
+    int samples;
+    double totalCores;
+    double freeCores;
+    double runningCores;
+    double totalNodes;
+    double upNodes;
+    double downNodes;
+    double idleNodes;
+    double runningJobs;
+    double pendingJobs;
+  };
+
+  explicit HistoryLog(QString directory, QObject *parent = nullptr);
+
+  static QString defaultDirectory();
+
+  QString filename(QDate day);
+
+  int append(QDateTime time, const QVector<Queue *> &queues,
+             const QVector<Qjob *> &jobs);
+
+  int query(QDateTime from, QDateTime to, int interval,
+            QVector<Usage> &usage);
+
+private:
+  /// Start of every log file
+  struct FileHeader {
+    quint32 magic;
+    quint32 version;
+  };
+
+  /// Start of every snapshot, followed by its queue and job records
+  struct SnapshotHeader {
+    quint32 magic;
+    quint32 size;
+    qint64 time;
+    quint32 nQueues;
+    quint32 nJobs;
+  };
+
+  /// Health counters of one queue in a snapshot, with the queue hash stored
+  /// as raw bytes
+  struct QueueRecord {
+    char hash[20];
+    qint32 totalCores;
+    qint32 freeCores;
+    qint32 runningCores;
+    qint32 totalNodes;
+    qint32 upNodes;
+    qint32 downNodes;
+    qint32 idleNodes;
+    qint32 jobs;
+  };
+
+  /// One job in a snapshot. Bit i of queues is set for the i-th queue
+  /// record of the same snapshot
+  struct JobRecord {
+    qint32 jobNumber;
+    qint32 status;
+    qint32 ncpu;
+    qint32 reserved;
+    quint64 queues;
+    qint64 time;
+    char user[16];
+  };
+
+  typedef QMap<qint64, QMap<QByteArray, Usage> > Buckets;
+
+  int _scan(QString filename, qint64 from, qint64 to, qint64 interval,
+            Buckets &buckets);
+  void _add(const uchar *snapshot, const SnapshotHeader &header,
+            qint64 interval, Buckets &buckets);
+
+  /// Magic number written at the start of a log file
+  static const quint32 _magic = 0x51564c47;
+
+  /// Magic number written at the start of each snapshot
+  static const quint32 _snapshotMagic = 0x51565348;
+
+  /// Version of the log layout
+  static const quint32 _version = 1;
+
+  /// Directory holding one log file per day
+  QString _mDirectory;
+};
+
+#endif // HISTORYLOG_H
@@ -0,0 +1,182 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: hoststatusparser.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "hoststatusparser.h"
+
+/**
+ * @brief HostStatusParser::Instance::isDown Checks if the queue instance
+ * cannot run jobs. Unknown, error, disabled, suspended, calendar suspended
+ * and orphaned instances are down. Load and consumable alarms are not
+ * @return true if the instance is down
+ */
+bool HostStatusParser::Instance::isDown() const {
+  for (int i = 0; i < this->state.size(); i++) {
+    switch (this->state.at(i).toLatin1()) {
+    case 'u':
+    case 'E':
+    case 'd':
+    case 'D':
+    case 's':
+    case 'S':
+    case 'C':
+    case 'o':
+      return true;
+    default:
+      break;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief HostStatusParser::Instance::shortName Returns the instance name
+ * without the domain of its host. Queue names may hold dots themselves, as
+ * in all.q, so only the part after the @ is cut
+ * @return name as queue@host
+ */
+QString HostStatusParser::Instance::shortName() const {
+  int end = this->name.indexOf('.', this->name.indexOf('@') + 1);
+  if (end < 0)
+    return this->name;
+  return this->name.left(end);
+}
+
+/**
+ * @brief HostStatusParser::HostStatusParser Default constructor
+ * @param callback function called with each queue instance
+ */
+HostStatusParser::HostStatusParser(Callback callback) {
+  this->_mCallback = callback;
+  this->_mDepth = -1;
+  this->_mInstancesParsed = 0;
+}
+
+/**
+ * @brief HostStatusParser::instancesParsed Returns the number of queue
+ * instances seen
+ * @return number of queue instances
+ */
+int HostStatusParser::instancesParsed() { return this->_mInstancesParsed; }
+
+/**
+ * @brief HostStatusParser::hasError Checks if the document is malformed.
+ * Running out of data is not an error since more may still arrive
+ * @return true if the xml could not be parsed
+ */
+bool HostStatusParser::hasError() {
+  return this->_mReader.hasError() &&
+         this->_mReader.error() !=
+             QXmlStreamReader::PrematureEndOfDocumentError;
+}
+
+/**
+ * @brief HostStatusParser::addData Parses the next piece of qstat -f -xml
+ * output. Each queue instance is handed to the callback as soon as its
+ * element is complete
+ * @param data next chunk of output
+ */
+void HostStatusParser::addData(const QByteArray &data) {
+  if (this->_mReader.tokenType() == QXmlStreamReader::EndDocument)
+    this->_mReader.clear();
+  this->_mReader.addData(data);
+  this->_parse();
+  return;
+}
+
+/**
+ * @brief HostStatusParser::_parse Reads every complete token available. Only
+ * the direct children of a Queue-List element are read, since the job lists
+ * nested inside it reuse names such as state
+ */
+void HostStatusParser::_parse() {
+  if (this->_mReader.tokenType() == QXmlStreamReader::EndDocument)
+    return;
+
+  forever {
+    QXmlStreamReader::TokenType token = this->_mReader.readNext();
+
+    if (token == QXmlStreamReader::Invalid ||
+        token == QXmlStreamReader::EndDocument)
+      break;
+
+    if (token == QXmlStreamReader::StartElement) {
+      if (this->_mDepth < 0) {
+        if (this->_mReader.name() == "Queue-List") {
+          this->_mDepth = 0;
+          this->_mCurrent = Instance();
+          this->_mCurrent.slotsUsed = 0;
+          this->_mCurrent.slotsReserved = 0;
+          this->_mCurrent.slotsTotal = 0;
+          this->_mCurrent.loadAverage = 0.0;
+        }
+        continue;
+      }
+      this->_mDepth++;
+      QStringRef name = this->_mReader.name();
+      if (this->_mDepth == 1 &&
+          (name == "name" || name == "state" || name == "slots_used" ||
+           name == "slots_resv" || name == "slots_total" ||
+           name == "load_avg")) {
+        this->_mElement = name.toString();
+        this->_mText.clear();
+      }
+    } else if (token == QXmlStreamReader::Characters) {
+      if (!this->_mElement.isEmpty())
+        this->_mText.append(this->_mReader.text());
+    } else if (token == QXmlStreamReader::EndElement) {
+      if (this->_mDepth < 0)
+        continue;
+      if (this->_mDepth == 0) {
+        this->_mDepth = -1;
+        this->_mInstancesParsed++;
+        if (this->_mCallback)
+          this->_mCallback(this->_mCurrent);
+        continue;
+      }
+      if (this->_mDepth == 1 && !this->_mElement.isEmpty()) {
+        this->_apply();
+        this->_mElement.clear();
+      }
+      this->_mDepth--;
+    }
+  }
+  return;
+}
+
+/**
+ * @brief HostStatusParser::_apply Stores the text of a completed element in
+ * the current queue instance
+ */
+void HostStatusParser::_apply() {
+  if (this->_mElement == "name")
+    this->_mCurrent.name = this->_mText.trimmed();
+  else if (this->_mElement == "state")
+    this->_mCurrent.state = this->_mText.trimmed();
+  else if (this->_mElement == "slots_used")
+    this->_mCurrent.slotsUsed = this->_mText.toInt();
+  else if (this->_mElement == "slots_resv")
+    this->_mCurrent.slotsReserved = this->_mText.toInt();
+  else if (this->_mElement == "slots_total")
+    this->_mCurrent.slotsTotal = this->_mText.toInt();
+  else if (this->_mElement == "load_avg")
+    this->_mCurrent.loadAverage = this->_mText.toDouble();
+  return;
+}
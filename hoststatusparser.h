@@ -0,0 +1,85 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: hoststatusparser.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef HOSTSTATUSPARSER_H
+#define HOSTSTATUSPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QXmlStreamReader>
+#include <functional>
+
+class HostStatusParser {
+public:
+  /// State of one queue instance as reported by qstat -f -xml
+  struct Instance {
+    QString name;
+    QString state;
+    int slotsUsed;
+    int slotsReserved;
+    int slotsTotal;
+    double loadAverage;
+
+    bool isDown() const;
+    QString shortName() const;
+  };
+
+  /// Function called with each queue instance once it has been read
+  typedef std::function<void(const Instance &instance)> Callback;
+
+  explicit HostStatusParser(Callback callback);
+
+  void addData(const QByteArray &data);
+
+  int instancesParsed();
+
+  bool hasError();
+
+private:
+  void _parse();
+  void _apply();
+
+  /// Reader fed with output as it arrives
+  QXmlStreamReader _mReader;
+
+  /// Function called with each queue instance
+  Callback _mCallback;
+
+  /// Queue instance currently being read
+  Instance _mCurrent;
+
+  /// Depth below the current Queue-List element, -1 outside of one
+  int _mDepth;
+
+  /// Name of the element whose text is being collected, empty if none
+  QString _mElement;
+
+  /// Text collected for the current element
+  QString _mText;
+
+  /// Number of queue instances seen so far
+  int _mInstancesParsed;
+
+  HostStatusParser(const HostStatusParser &) = delete;
+  HostStatusParser &operator=(const HostStatusParser &) = delete;
+};
+
+#endif // HOSTSTATUSPARSER_H
@@ -0,0 +1,120 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: hosttable.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "hosttable.h"
+
+/**
+ * @brief HostTable::HostTable Constructor
+ * @param index lookup from hosts to the queues that own them
+ * @param parent Pointer to parent object
+ */
+HostTable::HostTable(QueueIndex *index, QObject *parent) : QObject(parent) {
+  this->_mIndex = index;
+  this->_mGeneration = 0;
+}
+
+/**
+ * @brief HostTable::beginRefresh Starts a refresh of the host states. Only
+ * queue instances that are new, have changed or have gone since the last
+ * refresh touch the counters, so a refresh costs the number of changes on
+ * top of reading the output
+ * @param queues every queue whose health is counted from the hosts
+ */
+void HostTable::beginRefresh(const QVector<Queue *> &queues) {
+  //...Without a table, e.g. after reading a snapshot, the
+  //   counters cannot be trusted and are built from scratch
+  if (this->_mHostStates.isEmpty())
+    for (int i = 0; i < queues.size(); i++)
+      queues[i]->resetHealth();
+
+  this->_mGeneration++;
+  return;
+}
+
+/**
+ * @brief HostTable::endRefresh Takes every queue instance that was not seen
+ * in a complete refresh out of the counters
+ */
+void HostTable::endRefresh() {
+  QHash<QString, HostState>::iterator it = this->_mHostStates.begin();
+  while (it != this->_mHostStates.end()) {
+    if (it.value().generation != this->_mGeneration) {
+      for (int j = 0; j < it.value().queues.size(); j++)
+        it.value().queues[j]->removeNodeHealth(it.value().isDown,
+                                               it.value().usedCores);
+      it = this->_mHostStates.erase(it);
+    } else
+      ++it;
+  }
+  return;
+}
+
+/**
+ * @brief HostTable::setState Records the state of a queue instance and
+ * applies any change to the queues that own its host
+ * @param instance queue instance read from qstat -f -xml
+ */
+void HostTable::setState(const HostStatusParser::Instance &instance) {
+  QString name = instance.shortName();
+  bool isDown = instance.isDown();
+  int usedCores = instance.slotsUsed;
+  QHash<QString, HostState>::iterator it = this->_mHostStates.find(name);
+
+  if (it == this->_mHostStates.end()) {
+    HostState state;
+    state.isDown = isDown;
+    state.usedCores = usedCores;
+    state.generation = this->_mGeneration;
+    state.queues = this->_mIndex->queuesOnHost(name);
+    for (int j = 0; j < state.queues.size(); j++)
+      state.queues[j]->addNodeHealth(isDown, usedCores);
+    this->_mHostStates.insert(name, state);
+    return;
+  }
+
+  HostState &state = it.value();
+  state.generation = this->_mGeneration;
+  if (state.isDown == isDown && state.usedCores == usedCores)
+    return;
+
+  for (int j = 0; j < state.queues.size(); j++) {
+    state.queues[j]->removeNodeHealth(state.isDown, state.usedCores);
+    state.queues[j]->addNodeHealth(isDown, usedCores);
+  }
+  state.isDown = isDown;
+  state.usedCores = usedCores;
+  return;
+}
+
+/**
+ * @brief HostTable::clear Forgets every queue instance, so the next refresh
+ * rebuilds the counters from scratch
+ */
+void HostTable::clear() {
+  this->_mHostStates.clear();
+  return;
+}
+
+/**
+ * @brief HostTable::size Returns the number of queue instances known
+ * @return number of queue instances
+ */
+int HostTable::size() { return this->_mHostStates.size(); }
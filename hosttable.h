@@ -0,0 +1,67 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: hosttable.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef HOSTTABLE_H
+#define HOSTTABLE_H
+
+#include "hoststatusparser.h"
+#include "queue.h"
+#include "queueindex.h"
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class HostTable : public QObject {
+  Q_OBJECT
+public:
+  explicit HostTable(QueueIndex *index, QObject *parent = nullptr);
+
+  void beginRefresh(const QVector<Queue *> &queues);
+
+  void setState(const HostStatusParser::Instance &instance);
+
+  void endRefresh();
+
+  void clear();
+
+  int size();
+
+private:
+  /// Last known state of a queue instance, as counted in the queues
+  struct HostState {
+    bool isDown;
+    int usedCores;
+    int generation;
+    QVector<Queue *> queues;
+  };
+
+  /// Lookup from hosts to the queues that own them
+  QueueIndex *_mIndex;
+
+  /// Last known state of every queue instance by queue@host name
+  QHash<QString, HostState> _mHostStates;
+
+  /// Incremented on each refresh to find instances that have gone
+  int _mGeneration;
+};
+
+#endif // HOSTTABLE_H
@@ -0,0 +1,195 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: jobcache.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "jobcache.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+/**
+ * @brief JobCache::JobCache Default constructor
+ * @param parent Pointer to parent object
+ */
+JobCache::JobCache(QObject *parent) : QObject(parent) {
+  this->_mModified = false;
+}
+
+/**
+ * @brief JobCache::defaultFilename Returns the default location of the cache
+ * file, $XDG_CACHE_HOME/qview/jobcache.dat
+ * @return path to the cache file
+ */
+QString JobCache::defaultFilename() {
+  return QStandardPaths::writableLocation(
+             QStandardPaths::GenericCacheLocation) +
+         "/qview/jobcache.dat";
+}
+
+/**
+ * @brief JobCache::_key Generates the cache key for a job. The time is part
+ * of the key so that a reused job number never matches an old entry
+ * @param job job to make the key for
+ * @return cache key
+ */
+JobCache::Key JobCache::_key(const Qjob &job) {
+  return Key(job.jobNumber(), job.time().toMSecsSinceEpoch());
+}
+
+/**
+ * @brief JobCache::size Returns the number of cached jobs
+ * @return number of cached jobs
+ */
+int JobCache::size() { return this->_mEntries.size(); }
+
+/**
+ * @brief JobCache::load Reads the cache from disk. A missing or unreadable
+ * file leaves the cache empty
+ * @param filename file to read from
+ * @return status code
+ */
+int JobCache::load(QString filename) {
+  quint32 magic, version;
+  qint32 n;
+
+  this->_mFilename = filename;
+  this->_mEntries.clear();
+  this->_mModified = false;
+
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly))
+    return 1;
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  stream >> magic >> version;
+  if (magic != _magic || version != _version)
+    return 1;
+
+  stream >> n;
+  for (int i = 0; i < n && stream.status() == QDataStream::Ok; i++) {
+    qint32 jobNumber;
+    qint64 time;
+    Entry entry;
+    stream >> jobNumber >> time >> entry.jobName >> entry.queueName >>
+        entry.ncpu >> entry.nodes;
+    if (stream.status() == QDataStream::Ok)
+      this->_mEntries[Key(jobNumber, time)] = entry;
+  }
+
+  return stream.status() == QDataStream::Ok ? 0 : 1;
+}
+
+/**
+ * @brief JobCache::save Writes the cache to disk if it has changed. The file
+ * is replaced atomically so concurrent runs never see a partial cache
+ * @return status code
+ */
+int JobCache::save() {
+  if (!this->_mModified || this->_mFilename.isEmpty())
+    return 0;
+
+  QDir().mkpath(QFileInfo(this->_mFilename).absolutePath());
+
+  QSaveFile file(this->_mFilename);
+  if (!file.open(QIODevice::WriteOnly))
+    return 1;
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  stream << _magic << _version << qint32(this->_mEntries.size());
+  for (QHash<Key, Entry>::const_iterator it = this->_mEntries.constBegin();
+       it != this->_mEntries.constEnd(); ++it) {
+    stream << qint32(it.key().first) << qint64(it.key().second)
+           << it.value().jobName << it.value().queueName
+           << qint32(it.value().ncpu) << it.value().nodes;
+  }
+
+  if (!file.commit())
+    return 1;
+
+  this->_mModified = false;
+  return 0;
+}
+
+/**
+ * @brief JobCache::lookup Fills in the job details from the cache
+ * @param job pointer to the job to fill in
+ * @return true if the job was found in the cache
+ */
+bool JobCache::lookup(Qjob *job) {
+  QHash<Key, Entry>::const_iterator it =
+      this->_mEntries.constFind(_key(*job));
+  if (it == this->_mEntries.constEnd())
+    return false;
+
+  job->setJobName(it.value().jobName);
+  job->setQueueName(it.value().queueName);
+  job->setNcpu(it.value().ncpu);
+  for (int i = 0; i < it.value().nodes.size(); i++)
+    job->addCoreList(it.value().nodes[i]);
+  job->setHasDetails(true);
+  return true;
+}
+
+/**
+ * @brief JobCache::insert Adds the details of a job to the cache
+ * @param job pointer to a job with details from the scheduler
+ */
+void JobCache::insert(Qjob *job) {
+  if (!job->hasDetails())
+    return;
+
+  Entry entry;
+  entry.jobName = job->jobName();
+  entry.queueName = job->queueName();
+  entry.ncpu = job->ncpu();
+  entry.nodes = job->coreList();
+  this->_mEntries[_key(*job)] = entry;
+  this->_mModified = true;
+  return;
+}
+
+/**
+ * @brief JobCache::retain Evicts every entry whose job no longer appears in
+ * the scheduler listing
+ * @param jobs all jobs in the current listing
+ */
+void JobCache::retain(const QVector<Qjob> &jobs) {
+  QSet<Key> current;
+  for (int i = 0; i < jobs.size(); i++)
+    current.insert(_key(jobs[i]));
+
+  QHash<Key, Entry>::iterator it = this->_mEntries.begin();
+  while (it != this->_mEntries.end()) {
+    if (!current.contains(it.key())) {
+      it = this->_mEntries.erase(it);
+      this->_mModified = true;
+    } else
+      ++it;
+  }
+  return;
+}
@@ -0,0 +1,78 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: jobcache.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef JOBCACHE_H
+#define JOBCACHE_H
+
+#include "qjob.h"
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QVector>
+
+class JobCache : public QObject {
+  Q_OBJECT
+public:
+  explicit JobCache(QObject *parent = nullptr);
+
+  static QString defaultFilename();
+
+  int load(QString filename);
+  int save();
+
+  bool lookup(Qjob *job);
+  void insert(Qjob *job);
+  void retain(const QVector<Qjob> &jobs);
+
+  int size();
+
+private:
+  /// Job details that do not change while a job is alive
+  struct Entry {
+    QString jobName;
+    QString queueName;
+    int ncpu;
+    QList<int> nodes;
+  };
+
+  /// Cache key made of the job number and the submit or start time
+  typedef QPair<int, qint64> Key;
+
+  static Key _key(const Qjob &job);
+
+  /// Magic number written at the start of the cache file
+  static const quint32 _magic = 0x51564a43;
+
+  /// Version of the cache file layout
+  static const quint32 _version = 1;
+
+  /// Cached job details
+  QHash<Key, Entry> _mEntries;
+
+  /// File the cache is read from and written to
+  QString _mFilename;
+
+  /// True if the cache has changed since it was loaded
+  bool _mModified;
+};
+
+#endif // JOBCACHE_H
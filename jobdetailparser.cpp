@@ -0,0 +1,199 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: jobdetailparser.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "jobdetailparser.h"
+#include <QStringList>
+
+/**
+ * @brief JobDetailParser::JobDetailParser Default constructor
+ * @param jobMap mapping from job number to the jobs that receive the detail
+ * @param index index of the configured queues used to read node numbers
+ * from host names. Without it the last three digits, or the last one, are
+ * used
+ */
+JobDetailParser::JobDetailParser(QMap<int, QVector<Qjob *> > *jobMap,
+                                 const QueueIndex *index) {
+  this->_mJobMap = jobMap;
+  this->_mIndex = index;
+  this->_mFoundCoreCount = false;
+  this->_mFoundQueue = false;
+  this->_mJobsParsed = 0;
+  this->_mDepth = 0;
+  this->_mRecordDepth = -1;
+}
+
+/**
+ * @brief JobDetailParser::jobsParsed Returns the number of job records seen
+ * @return number of job records
+ */
+int JobDetailParser::jobsParsed() { return this->_mJobsParsed; }
+
+/**
+ * @brief JobDetailParser::hasError Checks if the document is malformed.
+ * Running out of data is not an error since more may still arrive
+ * @return true if the xml could not be parsed
+ */
+bool JobDetailParser::hasError() {
+  return this->_mReader.hasError() &&
+         this->_mReader.error() !=
+             QXmlStreamReader::PrematureEndOfDocumentError;
+}
+
+/**
+ * @brief JobDetailParser::addData Parses the next piece of qstat -xml -j
+ * output. Only the part of the document that has not been parsed yet is
+ * kept, so memory use does not grow with the size of the document. Data
+ * given after a document has ended starts a new document
+ * @param data next chunk of output
+ */
+void JobDetailParser::addData(const QByteArray &data) {
+  if (this->_mReader.tokenType() == QXmlStreamReader::EndDocument) {
+    this->_mReader.clear();
+    this->_mCurrentJobs.clear();
+    this->_mElement.clear();
+    this->_mDepth = 0;
+    this->_mRecordDepth = -1;
+  }
+  this->_mReader.addData(data);
+  this->_parse();
+  return;
+}
+
+/**
+ * @brief JobDetailParser::_parse Reads every complete token available. Each
+ * job begins with its job number, so everything that follows belongs to
+ * that job until the element holding the job number is closed. Only then
+ * are the jobs marked as having their details, so a record cut off by a
+ * timeout is never taken for a complete one
+ */
+void JobDetailParser::_parse() {
+  if (this->_mReader.tokenType() == QXmlStreamReader::EndDocument)
+    return;
+
+  //...When the data runs out the reader reports a premature end of
+  //   document, and the next call picks up where it left off
+  forever {
+    QXmlStreamReader::TokenType token = this->_mReader.readNext();
+
+    if (token == QXmlStreamReader::Invalid ||
+        token == QXmlStreamReader::EndDocument)
+      break;
+
+    if (token == QXmlStreamReader::StartElement) {
+      QStringRef name = this->_mReader.name();
+      //...The record is closed when the depth drops back to where
+      //   it was before the element holding the job number
+      if (name == "JB_job_number")
+        this->_mRecordDepth = this->_mDepth - 1;
+      this->_mDepth++;
+      if (name == "JB_job_number" ||
+          (!this->_mCurrentJobs.isEmpty() &&
+           (name == "QR_name" || name == "JB_job_name" || name == "PET_id" ||
+            name == "JG_qhostname" ||
+            (name == "RN_max" && !this->_mFoundCoreCount)))) {
+        this->_mElement = name.toString();
+        this->_mText.clear();
+      }
+    } else if (token == QXmlStreamReader::Characters) {
+      if (!this->_mElement.isEmpty())
+        this->_mText.append(this->_mReader.text());
+    } else if (token == QXmlStreamReader::EndElement) {
+      if (!this->_mElement.isEmpty() &&
+          this->_mReader.name() == this->_mElement) {
+        this->_apply();
+        this->_mElement.clear();
+      }
+      this->_mDepth--;
+      if (this->_mDepth == this->_mRecordDepth)
+        this->_closeRecord();
+    }
+  }
+  return;
+}
+
+/**
+ * @brief JobDetailParser::_apply Merges the text of a completed element into
+ * the current jobs
+ */
+void JobDetailParser::_apply() {
+  QString coreName;
+  int nodeId;
+  bool ok;
+
+  if (this->_mElement == "JB_job_number") {
+    this->_mCurrentJobs = this->_mJobMap->value(this->_mText.toInt());
+    this->_mFoundCoreCount = false;
+    this->_mFoundQueue = false;
+    this->_mJobsParsed++;
+  } else if (this->_mElement == "QR_name") {
+    //...A request for several queues is kept as a comma separated
+    //   list, as it is read from the job listing
+    QString queueName = this->_mText;
+    if (queueName.left(1) == "*")
+      queueName = queueName.right(queueName.length() - 1);
+    for (int i = 0; i < this->_mCurrentJobs.size(); i++)
+      this->_mCurrentJobs[i]->setQueueName(
+          this->_mFoundQueue
+              ? this->_mCurrentJobs[i]->queueName() + "," + queueName
+              : queueName);
+    this->_mFoundQueue = true;
+  } else if (this->_mElement == "RN_max") {
+    this->_mFoundCoreCount = true;
+    int nCore = this->_mText.toInt();
+    for (int i = 0; i < this->_mCurrentJobs.size(); i++)
+      this->_mCurrentJobs[i]->setNcpu(nCore);
+  } else if (this->_mElement == "JB_job_name") {
+    for (int i = 0; i < this->_mCurrentJobs.size(); i++)
+      this->_mCurrentJobs[i]->setJobName(this->_mText);
+  } else if (this->_mElement == "PET_id" ||
+             this->_mElement == "JG_qhostname") {
+    if (this->_mElement == "PET_id")
+      coreName = this->_mText.split(".").value(1);
+    else
+      coreName = this->_mText.split(".").value(0);
+    //...A host outside every queue is left out rather than guessed
+    //   at, since its number could fall inside a queue's mask
+    QString nodeName;
+    if (this->_mIndex != nullptr)
+      ok = this->_mIndex->splitHost(coreName, nodeName, nodeId);
+    else {
+      nodeId = coreName.right(3).toInt(&ok);
+      if (!ok)
+        nodeId = coreName.right(1).toInt(&ok);
+    }
+    if (ok)
+      for (int i = 0; i < this->_mCurrentJobs.size(); i++)
+        this->_mCurrentJobs[i]->addCoreList(nodeId);
+  }
+  return;
+}
+
+/**
+ * @brief JobDetailParser::_closeRecord Marks the current jobs as complete
+ * once the element holding their record has been read to its end
+ */
+void JobDetailParser::_closeRecord() {
+  for (int i = 0; i < this->_mCurrentJobs.size(); i++)
+    this->_mCurrentJobs[i]->setHasDetails(true);
+  this->_mCurrentJobs.clear();
+  this->_mRecordDepth = -1;
+  return;
+}
@@ -0,0 +1,86 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: jobdetailparser.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef JOBDETAILPARSER_H
+#define JOBDETAILPARSER_H
+
+#include "qjob.h"
+#include "queueindex.h"
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <QXmlStreamReader>
+
+class JobDetailParser {
+public:
+  explicit JobDetailParser(QMap<int, QVector<Qjob *> > *jobMap,
+                           const QueueIndex *index = nullptr);
+
+  void addData(const QByteArray &data);
+
+  int jobsParsed();
+
+  bool hasError();
+
+private:
+  void _parse();
+  void _apply();
+  void _closeRecord();
+
+  /// Reader fed with output as it arrives
+  QXmlStreamReader _mReader;
+
+  /// Mapping from job number to the jobs with that number
+  QMap<int, QVector<Qjob *> > *_mJobMap;
+
+  /// Index used to split host names into node numbers, may be null
+  const QueueIndex *_mIndex;
+
+  /// Jobs receiving the fields currently being read
+  QVector<Qjob *> _mCurrentJobs;
+
+  /// Name of the element whose text is being collected, empty if none
+  QString _mElement;
+
+  /// Text collected for the current element
+  QString _mText;
+
+  /// Logical value denoting if the slot count has been read for this job
+  bool _mFoundCoreCount;
+
+  /// Logical value denoting if a requested queue has been read for this job
+  bool _mFoundQueue;
+
+  /// Number of job records seen so far
+  int _mJobsParsed;
+
+  /// Number of elements open at the current position in the document
+  int _mDepth;
+
+  /// Depth at which the element holding the current job record ends, -1
+  /// when no record is open
+  int _mRecordDepth;
+
+  JobDetailParser(const JobDetailParser &) = delete;
+  JobDetailParser &operator=(const JobDetailParser &) = delete;
+};
+
+#endif // JOBDETAILPARSER_H
@@ -0,0 +1,253 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: jobexporter.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "jobexporter.h"
+#include <QJsonDocument>
+#include <QStringList>
+#include <cstdio>
+
+/**
+ * @brief JobExporter::JobExporter Constructor
+ * @param format output format
+ * @param queues queues whose jobs and health are exported
+ */
+JobExporter::JobExporter(Format format, const QVector<Queue *> &queues) {
+  this->_mFormat = format;
+  this->_mQueues = queues;
+  this->_mHeaderWritten = false;
+  for (int i = 0; i < queues.size(); i++)
+    this->_mHashes.push_back(queues[i]->hash());
+  this->_mJobCounts.fill(0, queues.size());
+}
+
+/**
+ * @brief JobExporter::parseFormat Converts a format name from the command
+ * line
+ * @param name json, ndjson or csv
+ * @param format set to the matching format
+ * @return true if the name is known
+ */
+bool JobExporter::parseFormat(QString name, Format &format) {
+  if (name == "json")
+    format = FormatJson;
+  else if (name == "ndjson")
+    format = FormatNdjson;
+  else if (name == "csv")
+    format = FormatCsv;
+  else
+    return false;
+  return true;
+}
+
+/**
+ * @brief JobExporter::addJob Exports a job if it is in one of the queues.
+ * ndjson and csv rows are written immediately, json is held until finish()
+ * @param job classified job
+ */
+void JobExporter::addJob(const Qjob &job) {
+  QStringList queues;
+  for (int i = 0; i < this->_mQueues.size(); i++) {
+    if (job.containsQueueHash(this->_mHashes[i])) {
+      queues << this->_mQueues[i]->queueName();
+      this->_mJobCounts[i]++;
+    }
+  }
+  if (queues.isEmpty())
+    return;
+
+  if (this->_mFormat == FormatJson) {
+    this->_mJobs.append(this->_jobObject(job, queues));
+  } else if (this->_mFormat == FormatNdjson) {
+    this->_write(QJsonDocument(this->_jobObject(job, queues))
+                     .toJson(QJsonDocument::Compact) +
+                 "\n");
+  } else {
+    this->_writeCsvHeader();
+    QStringList row;
+    row << "job" << QString::number(job.jobNumber()) << job.jobName()
+        << job.user() << job.statusString()
+        << QString::number(job.priority(), 'f', 5)
+        << job.time().toString(Qt::ISODate) << QString::number(job.ncpu())
+        << job.queueName() << job.node() << queues.join(";")
+        << (job.hasDetails() ? "false" : "true");
+    for (int i = 0; i < _csvQueueColumns; i++)
+      row << QString();
+    this->_writeCsvRow(row);
+  }
+  return;
+}
+
+/**
+ * @brief JobExporter::finish Writes the health of every queue and, for
+ * json, the whole document. csv queue rows follow the job rows in the same
+ * table, told apart by their type column
+ */
+void JobExporter::finish() {
+  if (this->_mFormat == FormatJson) {
+    QJsonArray queues;
+    for (int i = 0; i < this->_mQueues.size(); i++)
+      queues.append(this->_queueObject(i));
+    QJsonObject document;
+    document["jobs"] = this->_mJobs;
+    document["queues"] = queues;
+    this->_write(QJsonDocument(document).toJson(QJsonDocument::Indented));
+    this->_mJobs = QJsonArray();
+  } else if (this->_mFormat == FormatNdjson) {
+    for (int i = 0; i < this->_mQueues.size(); i++)
+      this->_write(QJsonDocument(this->_queueObject(i))
+                       .toJson(QJsonDocument::Compact) +
+                   "\n");
+  } else {
+    this->_writeCsvHeader();
+    for (int i = 0; i < this->_mQueues.size(); i++) {
+      Queue *q = this->_mQueues[i];
+      QStringList row;
+      row << "queue";
+      for (int j = 0; j < _csvJobColumns; j++)
+        row << QString();
+      row << q->machine() << q->queueName()
+          << QString::number(this->_mJobCounts[i])
+          << QString::number(q->queueTotalCores())
+          << QString::number(q->queueFreeCores())
+          << QString::number(q->queueRunningCores())
+          << QString::number(q->queueTotalNodes())
+          << QString::number(q->queueUpNodes())
+          << QString::number(q->queueDownNodes())
+          << QString::number(q->queueIdleNodes());
+      this->_writeCsvRow(row);
+    }
+  }
+  return;
+}
+
+/**
+ * @brief JobExporter::_writeCsvHeader Writes the csv header once. Jobs and
+ * queues share one set of columns so the output reads as a single table.
+ * The type column holds job or queue and the columns of the other kind of
+ * row are left empty
+ */
+void JobExporter::_writeCsvHeader() {
+  if (this->_mHeaderWritten)
+    return;
+  this->_writeCsvRow(QStringList() << "type"
+                                   << "job_number"
+                                   << "name"
+                                   << "user"
+                                   << "status"
+                                   << "priority"
+                                   << "time"
+                                   << "ncpu"
+                                   << "queue_name"
+                                   << "node"
+                                   << "queues"
+                                   << "incomplete"
+                                   << "machine"
+                                   << "queue"
+                                   << "jobs"
+                                   << "total_cores"
+                                   << "free_cores"
+                                   << "running_cores"
+                                   << "total_nodes"
+                                   << "up_nodes"
+                                   << "down_nodes"
+                                   << "idle_nodes");
+  this->_mHeaderWritten = true;
+  return;
+}
+
+/**
+ * @brief JobExporter::_jobObject Builds the json record of a job
+ * @param job job to describe
+ * @param queues names of the exported queues the job is in
+ * @return json object
+ */
+QJsonObject JobExporter::_jobObject(const Qjob &job,
+                                    const QStringList &queues) {
+  QJsonObject object;
+  object["type"] = QStringLiteral("job");
+  object["job_number"] = job.jobNumber();
+  object["name"] = job.jobName();
+  object["user"] = job.user();
+  object["status"] = job.statusString();
+  object["priority"] = job.priority();
+  object["time"] = job.time().toString(Qt::ISODate);
+  object["ncpu"] = job.ncpu();
+  object["queue_name"] = job.queueName();
+  object["node"] = job.node();
+  object["queues"] = QJsonArray::fromStringList(queues);
+  object["incomplete"] = !job.hasDetails();
+  return object;
+}
+
+/**
+ * @brief JobExporter::_queueObject Builds the json record of a queue
+ * @param index index of the queue in the exported queues
+ * @return json object
+ */
+QJsonObject JobExporter::_queueObject(int index) {
+  Queue *q = this->_mQueues[index];
+  QJsonObject object;
+  object["type"] = QStringLiteral("queue");
+  object["machine"] = q->machine();
+  object["queue"] = q->queueName();
+  object["jobs"] = this->_mJobCounts[index];
+  object["total_cores"] = q->queueTotalCores();
+  object["free_cores"] = q->queueFreeCores();
+  object["running_cores"] = q->queueRunningCores();
+  object["total_nodes"] = q->queueTotalNodes();
+  object["up_nodes"] = q->queueUpNodes();
+  object["down_nodes"] = q->queueDownNodes();
+  object["idle_nodes"] = q->queueIdleNodes();
+  return object;
+}
+
+/**
+ * @brief JobExporter::_writeCsvRow Writes one csv row, quoting the fields
+ * that need it
+ * @param fields values in the row
+ */
+void JobExporter::_writeCsvRow(const QStringList &fields) {
+  QByteArray row;
+  for (int i = 0; i < fields.size(); i++) {
+    QByteArray field = fields[i].toUtf8();
+    if (i > 0)
+      row.append(',');
+    if (field.contains(',') || field.contains('"') || field.contains('\n')) {
+      field.replace("\"", "\"\"");
+      row.append('"').append(field).append('"');
+    } else
+      row.append(field);
+  }
+  row.append('\n');
+  this->_write(row);
+  return;
+}
+
+/**
+ * @brief JobExporter::_write Writes to standard output right away so that
+ * readers see each row as soon as it is known
+ * @param data data to write
+ */
+void JobExporter::_write(const QByteArray &data) {
+  fwrite(data.constData(), 1, size_t(data.size()), stdout);
+  fflush(stdout);
+  return;
+}
@@ -0,0 +1,76 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: jobexporter.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef JOBEXPORTER_H
+#define JOBEXPORTER_H
+
+#include "qjob.h"
+#include "queue.h"
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+class JobExporter {
+public:
+  /// Machine readable output formats
+  enum Format { FormatJson, FormatNdjson, FormatCsv };
+
+  explicit JobExporter(Format format, const QVector<Queue *> &queues);
+
+  static bool parseFormat(QString name, Format &format);
+
+  void addJob(const Qjob &job);
+
+  void finish();
+
+private:
+  /// Number of csv columns that only job rows or only queue rows fill
+  static const int _csvJobColumns = 11;
+  static const int _csvQueueColumns = 10;
+
+  QJsonObject _jobObject(const Qjob &job, const QStringList &queues);
+  QJsonObject _queueObject(int index);
+  void _writeCsvHeader();
+  void _writeCsvRow(const QStringList &fields);
+  void _write(const QByteArray &data);
+
+  /// Format being written
+  Format _mFormat;
+
+  /// Queues being exported
+  QVector<Queue *> _mQueues;
+
+  /// Hash of each queue being exported
+  QVector<QByteArray> _mHashes;
+
+  /// Number of jobs exported for each queue
+  QVector<int> _mJobCounts;
+
+  /// Jobs held until the end of a json document
+  QJsonArray _mJobs;
+
+  /// True once the csv header has been written
+  bool _mHeaderWritten;
+};
+
+#endif // JOBEXPORTER_H
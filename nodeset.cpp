@@ -0,0 +1,129 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: nodeset.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "nodeset.h"
+#include <QtAlgorithms>
+
+/**
+ * @brief NodeSet::NodeSet Default constructor. Creates an empty set
+ */
+NodeSet::NodeSet() {}
+
+/**
+ * @brief NodeSet::insert Adds a node number to the set
+ * @param node node number, numbers outside of 0 to maxNodeNumber - 1 are
+ * ignored
+ */
+void NodeSet::insert(int node) {
+  if (node < 0 || node >= maxNodeNumber)
+    return;
+  int word = node / 64;
+  if (word >= this->_mWords.size())
+    this->_mWords.resize(word + 1);
+  this->_mWords[word] |= quint64(1) << (node % 64);
+  return;
+}
+
+/**
+ * @brief NodeSet::insertRange Adds every node number in a range to the set.
+ * The range is cut to 0 to maxNodeNumber - 1
+ * @param first first node number in the range
+ * @param last last node number in the range
+ */
+void NodeSet::insertRange(int first, int last) {
+  int end = qMin(last, maxNodeNumber - 1);
+  for (int i = qMax(first, 0); i <= end; i++)
+    this->insert(i);
+  return;
+}
+
+/**
+ * @brief NodeSet::contains Checks if a node number is in the set
+ * @param node node number
+ * @return true if the node is in the set
+ */
+bool NodeSet::contains(int node) const {
+  if (node < 0)
+    return false;
+  int word = node / 64;
+  if (word >= this->_mWords.size())
+    return false;
+  return (this->_mWords[word] >> (node % 64)) & 1;
+}
+
+/**
+ * @brief NodeSet::intersects Checks if any node is in both sets
+ * @param other set to compare against
+ * @return true if the sets share a node
+ */
+bool NodeSet::intersects(const NodeSet &other) const {
+  int n = qMin(this->_mWords.size(), other._mWords.size());
+  for (int i = 0; i < n; i++)
+    if (this->_mWords[i] & other._mWords[i])
+      return true;
+  return false;
+}
+
+/**
+ * @brief NodeSet::isEmpty Checks if the set has no nodes
+ * @return true if the set is empty
+ */
+bool NodeSet::isEmpty() const {
+  for (int i = 0; i < this->_mWords.size(); i++)
+    if (this->_mWords[i] != 0)
+      return false;
+  return true;
+}
+
+/**
+ * @brief NodeSet::size Returns the number of nodes in the set
+ * @return number of nodes
+ */
+int NodeSet::size() const {
+  int n = 0;
+  for (int i = 0; i < this->_mWords.size(); i++)
+    n += qPopulationCount(this->_mWords[i]);
+  return n;
+}
+
+/**
+ * @brief NodeSet::clear Removes every node from the set
+ */
+void NodeSet::clear() {
+  this->_mWords.clear();
+  return;
+}
+
+/**
+ * @brief NodeSet::toList Returns the node numbers in the set in ascending
+ * order
+ * @return list of node numbers
+ */
+QList<int> NodeSet::toList() const {
+  QList<int> nodes;
+  for (int i = 0; i < this->_mWords.size(); i++) {
+    quint64 word = this->_mWords[i];
+    for (int j = 0; word != 0; j++, word >>= 1)
+      if (word & 1)
+        nodes.append(i * 64 + j);
+  }
+  return nodes;
+}
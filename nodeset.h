@@ -0,0 +1,50 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: nodeset.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef NODESET_H
+#define NODESET_H
+
+#include <QList>
+#include <QVector>
+
+class NodeSet {
+public:
+  /// Node numbers must be below this, so a set never grows past 128 kB
+  static const int maxNodeNumber = 1 << 20;
+
+  NodeSet();
+
+  void insert(int node);
+  void insertRange(int first, int last);
+  bool contains(int node) const;
+  bool intersects(const NodeSet &other) const;
+  bool isEmpty() const;
+  int size() const;
+  void clear();
+
+  QList<int> toList() const;
+
+private:
+  /// Bit n of word n/64 is set when node n is in the set
+  QVector<quint64> _mWords;
+};
+
+#endif // NODESET_H
@@ -0,0 +1,265 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: profiler.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "profiler.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSaveFile>
+#include <QStringList>
+#include <algorithm>
+
+/**
+ * @brief Profiler::Profiler Constructor. Times are measured from the moment
+ * the profiler is created
+ * @param parent Pointer to parent object
+ */
+Profiler::Profiler(QObject *parent) : QObject(parent) {
+  this->_mTimer.start();
+}
+
+/**
+ * @brief Profiler::now Returns the time since the profiler was created
+ * @return time in microseconds
+ */
+qint64 Profiler::now() { return this->_mTimer.nsecsElapsed() / 1000; }
+
+/**
+ * @brief Profiler::begin Starts a phase. Phases may nest but each must end
+ * before the phase around it
+ * @param name name of the phase
+ */
+void Profiler::begin(QString name) {
+  Event event;
+  event.name = name;
+  event.isCall = false;
+  event.start = this->now();
+  event.duration = 0;
+  event.bytes = 0;
+  event.depth = this->_mOpen.size();
+  this->_mOpen.push_back(event);
+  return;
+}
+
+/**
+ * @brief Profiler::end Ends the innermost phase
+ */
+void Profiler::end() {
+  if (this->_mOpen.isEmpty())
+    return;
+  Event event = this->_mOpen.takeLast();
+  event.duration = this->now() - event.start;
+  this->_mEvents.push_back(event);
+  return;
+}
+
+/**
+ * @brief Profiler::addCall Records a scheduler call that has just finished
+ * @param name description of the call
+ * @param start time the call was made, from now()
+ * @param bytes number of bytes of output read from the call
+ */
+void Profiler::addCall(QString name, qint64 start, qint64 bytes) {
+  Event event;
+  event.name = name;
+  event.isCall = true;
+  event.start = start;
+  event.duration = this->now() - start;
+  event.bytes = bytes;
+
+  //...The call is reported inside every phase that was already open
+  //   when it was made
+  event.depth = 0;
+  for (int i = 0; i < this->_mOpen.size(); i++)
+    if (this->_mOpen[i].start <= start)
+      event.depth = i + 1;
+
+  this->_mEvents.push_back(event);
+  return;
+}
+
+/**
+ * @brief Profiler::peakMemory Reads the peak resident set size of this
+ * process
+ * @return peak resident set size in kB, or -1 if it is not available
+ */
+qint64 Profiler::peakMemory() { return _statusValue("VmHWM:"); }
+
+/**
+ * @brief Profiler::residentMemory Reads the current resident set size of
+ * this process
+ * @return resident set size in kB, or -1 if it is not available
+ */
+qint64 Profiler::residentMemory() { return _statusValue("VmRSS:"); }
+
+/**
+ * @brief Profiler::_statusValue Reads a field of /proc/self/status
+ * @param field name of the field, including its colon
+ * @return value of the field in kB, or -1 if it is not available
+ */
+qint64 Profiler::_statusValue(const char *field) {
+  QFile status("/proc/self/status");
+  if (!status.open(QIODevice::ReadOnly))
+    return -1;
+  int length = qstrlen(field);
+  QList<QByteArray> lines = status.readAll().split('\n');
+  for (int i = 0; i < lines.size(); i++)
+    if (lines[i].startsWith(field))
+      return lines[i].mid(length).trimmed().split(' ').value(0).toLongLong();
+  return -1;
+}
+
+/**
+ * @brief Profiler::report Writes the time spent in each phase, every
+ * scheduler call and the peak memory use. Scheduler calls are also listed
+ * inside the phase they ran in, so a phase that waits on several calls at
+ * once shows the time of each. Phases and calls that ran more than once,
+ * such as on each refresh, are added together
+ * @param stream stream to write to
+ */
+void Profiler::report(QTextStream &stream) {
+  QVector<Event> events = this->_mEvents;
+  QStringList order;
+  QMap<QString, int> depth, count;
+  QMap<QString, qint64> total, longest;
+  qint64 calls = 0, bytes = 0;
+
+  //...Phases end inner first, so list them by when they began
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event &a, const Event &b) {
+                     return a.start < b.start;
+                   });
+
+  for (int i = 0; i < events.size(); i++) {
+    const Event &event = events[i];
+    if (!count.contains(event.name)) {
+      order.push_back(event.name);
+      depth[event.name] = event.depth;
+    }
+    count[event.name]++;
+    total[event.name] += event.duration;
+    longest[event.name] = qMax(longest[event.name], event.duration);
+  }
+
+  stream << QString("%1%2%3%4\n")
+                .arg("Phase", -30)
+                .arg("Count", 8)
+                .arg("Total ms", 12)
+                .arg("Max ms", 12);
+  for (int i = 0; i < order.size(); i++) {
+    QString name = QString(2 * depth[order[i]], ' ') + order[i];
+    stream << QString("%1%2%3%4\n")
+                  .arg(name, -30)
+                  .arg(count[order[i]], 8)
+                  .arg(total[order[i]] / 1000.0, 12, 'f', 1)
+                  .arg(longest[order[i]] / 1000.0, 12, 'f', 1);
+  }
+
+  stream << "\n"
+         << QString("%1%2%3%4\n")
+                .arg("Scheduler call", -30)
+                .arg("Start ms", 12)
+                .arg("Wall ms", 12)
+                .arg("Bytes", 12);
+  for (int i = 0; i < events.size(); i++) {
+    const Event &event = events[i];
+    if (!event.isCall)
+      continue;
+    calls++;
+    bytes += event.bytes;
+    stream << QString("%1%2%3%4\n")
+                  .arg(event.name, -30)
+                  .arg(event.start / 1000.0, 12, 'f', 1)
+                  .arg(event.duration / 1000.0, 12, 'f', 1)
+                  .arg(event.bytes, 12);
+  }
+
+  stream << "\n"
+         << "Scheduler calls:  " << calls << "\n"
+         << "Bytes read:       " << bytes << "\n"
+         << "Peak memory:      " << peakMemory() << " kB\n";
+  stream.flush();
+  return;
+}
+
+/**
+ * @brief Profiler::writeTrace Writes every phase and scheduler call as a
+ * Chrome trace event file, which can be opened in chrome://tracing or
+ * Perfetto. Phases are on the first thread and calls that overlap are
+ * spread over as many further threads as were needed
+ * @param filename file to write
+ * @return status code
+ */
+int Profiler::writeTrace(QString filename) {
+  QVector<Event> events = this->_mEvents;
+  QVector<qint64> laneEnd;
+  QJsonArray trace;
+  qint64 pid = QCoreApplication::applicationPid();
+
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event &a, const Event &b) {
+                     return a.start < b.start;
+                   });
+
+  for (int i = 0; i < events.size(); i++) {
+    const Event &event = events[i];
+    QJsonObject object;
+    QJsonObject args;
+    int lane = 0;
+
+    if (event.isCall) {
+      //...Put each call on the first lane that is free when it starts
+      while (lane < laneEnd.size() && laneEnd[lane] > event.start)
+        lane++;
+      if (lane == laneEnd.size())
+        laneEnd.push_back(0);
+      laneEnd[lane] = event.start + event.duration;
+      args["bytes"] = event.bytes;
+      lane++;
+    }
+
+    object["name"] = event.name;
+    object["cat"] = event.isCall ? "scheduler" : "phase";
+    object["ph"] = "X";
+    object["ts"] = event.start;
+    object["dur"] = event.duration;
+    object["pid"] = pid;
+    object["tid"] = lane;
+    if (event.isCall)
+      object["args"] = args;
+    trace.append(object);
+  }
+
+  QJsonObject document;
+  document["traceEvents"] = trace;
+  document["displayTimeUnit"] = "ms";
+
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    QTextStream(stderr) << "Unable to write a trace to " << filename << "\n";
+    return 1;
+  }
+  file.write(QJsonDocument(document).toJson(QJsonDocument::Compact));
+  return file.commit() ? 0 : 1;
+}
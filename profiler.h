@@ -0,0 +1,74 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: profiler.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+
+class Profiler : public QObject {
+  Q_OBJECT
+public:
+  explicit Profiler(QObject *parent = nullptr);
+
+  qint64 now();
+
+  void begin(QString name);
+  void end();
+
+  void addCall(QString name, qint64 start, qint64 bytes);
+
+  void report(QTextStream &stream);
+
+  int writeTrace(QString filename);
+
+  static qint64 peakMemory();
+
+  static qint64 residentMemory();
+
+private:
+  static qint64 _statusValue(const char *field);
+
+  /// A timed phase or scheduler call. Times are in microseconds
+  struct Event {
+    QString name;
+    bool isCall;
+    qint64 start;
+    qint64 duration;
+    qint64 bytes;
+    int depth;
+  };
+
+  /// Clock that all event times are measured from
+  QElapsedTimer _mTimer;
+
+  /// Finished phases and scheduler calls
+  QVector<Event> _mEvents;
+
+  /// Phases that have begun but not ended, innermost last
+  QVector<Event> _mOpen;
+};
+
+#endif // PROFILER_H
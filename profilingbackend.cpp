@@ -0,0 +1,175 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: profilingbackend.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "profilingbackend.h"
+#include <QSharedPointer>
+
+/**
+ * @brief ProfilingBackend::ProfilingBackend Constructor. Every call is passed
+ * to another backend and reported to a profiler with its wall time and the
+ * number of bytes it returned
+ * @param backend backend to time, ownership is taken
+ * @param profiler profiler to report to
+ * @param parent Pointer to parent object
+ */
+ProfilingBackend::ProfilingBackend(SchedulerBackend *backend,
+                                   Profiler *profiler, QObject *parent)
+    : SchedulerBackend(parent) {
+  this->_mBackend = backend;
+  this->_mBackend->setParent(this);
+  this->_mProfiler = profiler;
+  connect(this->_mBackend, SIGNAL(idle()), this, SIGNAL(idle()));
+}
+
+/**
+ * @brief ProfilingBackend::listJobs Lists the jobs
+ * @param queues queues running jobs are listed from, empty for all
+ * @param callback function called with the listing
+ */
+void ProfilingBackend::listJobs(QStringList queues, Callback callback) {
+  this->_mBackend->listJobs(queues, this->_timed("listJobs", callback));
+  return;
+}
+
+/**
+ * @brief ProfilingBackend::hostStatus Lists every queue instance
+ * @param dataCallback function called with each piece of xml output
+ * @param callback function called with the exit code
+ */
+void ProfilingBackend::hostStatus(DataCallback dataCallback,
+                                  Callback callback) {
+  this->_streamed("hostStatus", dataCallback, callback);
+  this->_mBackend->hostStatus(dataCallback, callback);
+  return;
+}
+
+/**
+ * @brief ProfilingBackend::jobDetails Asks for the details of a set of jobs
+ * @param jobIds job numbers to ask for
+ * @param dataCallback function called with each piece of xml output
+ * @param callback function called with the exit code
+ */
+void ProfilingBackend::jobDetails(QStringList jobIds,
+                                  DataCallback dataCallback,
+                                  Callback callback) {
+  this->_streamed(QString("jobDetails (%1 jobs)").arg(jobIds.size()),
+                  dataCallback, callback);
+  this->_mBackend->jobDetails(jobIds, dataCallback, callback);
+  return;
+}
+
+/**
+ * @brief ProfilingBackend::isIdle Checks if the timed backend is idle
+ * @return true if the backend is idle
+ */
+bool ProfilingBackend::isIdle() { return this->_mBackend->isIdle(); }
+
+/**
+ * @brief ProfilingBackend::maxProcesses Returns the maximum number of calls
+ * the timed backend runs at once
+ * @return maximum number of calls
+ */
+int ProfilingBackend::maxProcesses() { return this->_mBackend->maxProcesses(); }
+
+/**
+ * @brief ProfilingBackend::setMaxProcesses Sets the maximum number of calls
+ * the timed backend runs at once
+ * @param maxProcesses maximum number of calls
+ */
+void ProfilingBackend::setMaxProcesses(int maxProcesses) {
+  this->_mBackend->setMaxProcesses(maxProcesses);
+  return;
+}
+
+/**
+ * @brief ProfilingBackend::timeout Returns the time a call to the timed
+ * backend may run before it is stopped
+ * @return time in milliseconds, 0 if calls are never stopped
+ */
+int ProfilingBackend::timeout() { return this->_mBackend->timeout(); }
+
+/**
+ * @brief ProfilingBackend::setTimeout Sets the time a call to the timed
+ * backend may run before it is stopped
+ * @param msec time in milliseconds, 0 to never stop a call
+ */
+void ProfilingBackend::setTimeout(int msec) {
+  this->_mBackend->setTimeout(msec);
+  return;
+}
+
+/**
+ * @brief ProfilingBackend::cancel Stops every outstanding call to the
+ * timed backend
+ */
+void ProfilingBackend::cancel() {
+  this->_mBackend->cancel();
+  return;
+}
+
+/**
+ * @brief ProfilingBackend::_timed Wraps a callback so the call is reported
+ * to the profiler when it finishes. The time includes any wait for a free
+ * process slot
+ * @param name description of the call
+ * @param callback function to wrap
+ * @return wrapped function
+ */
+ProfilingBackend::Callback ProfilingBackend::_timed(QString name,
+                                                    Callback callback) {
+  qint64 start = this->_mProfiler->now();
+  Profiler *profiler = this->_mProfiler;
+  return [profiler, name, start, callback](int exitCode, QByteArray output) {
+    profiler->addCall(name, start, output.size());
+    if (callback)
+      callback(exitCode, output);
+  };
+}
+
+/**
+ * @brief ProfilingBackend::_streamed Wraps the callbacks of a streaming call
+ * so its output is counted as it arrives and the call is reported to the
+ * profiler when it finishes
+ * @param name description of the call
+ * @param dataCallback function to wrap, replaced with the wrapper
+ * @param callback function to wrap, replaced with the wrapper
+ */
+void ProfilingBackend::_streamed(QString name, DataCallback &dataCallback,
+                                 Callback &callback) {
+  QSharedPointer<qint64> bytes(new qint64(0));
+  qint64 start = this->_mProfiler->now();
+  Profiler *profiler = this->_mProfiler;
+  DataCallback data = dataCallback;
+  Callback done = callback;
+
+  dataCallback = [bytes, data](QByteArray chunk) {
+    *bytes += chunk.size();
+    if (data)
+      data(chunk);
+  };
+  callback = [profiler, bytes, name, start, done](int exitCode,
+                                                  QByteArray output) {
+    profiler->addCall(name, start, *bytes + output.size());
+    if (done)
+      done(exitCode, output);
+  };
+  return;
+}
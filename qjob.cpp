@@ -21,12 +21,12 @@
 
 #include "qjob.h"
 #include <QStringList>
+#include <cstring>
 
 /**
  * @brief Qjob::Qjob Default constructor
- * @param parent
  */
-Qjob::Qjob(QObject *parent) : QObject(parent) {
+Qjob::Qjob() {
   this->_mJobNumber = 0;
   this->_mPriority = 0.0;
   this->_mJobName = "none";
@@ -36,111 +36,332 @@ Qjob::Qjob(QObject *parent) : QObject(parent) {
   this->_mNcpus = 0;
   this->_mNode = "none";
   this->_mIsOnQueue = false;
+  this->_mHasDetails = false;
 }
 
 /**
  * @brief Qjob::fromQueueLine generates a job object from a queue line
  * @param line text from the queue line
- * @return job object
+ * @return status code
  */
 int Qjob::fromQueueLine(QString line) {
-  int tempInt;
+  QByteArray data = line.toUtf8();
+  return this->fromQueueLine(data.constData(), data.size());
+}
+
+/**
+ * @brief Qjob::fromQueueLine generates a job object from a queue line held
+ * in the raw qstat output. Fields are read in place without building any
+ * intermediate strings
+ * @param line pointer to the start of the line
+ * @param length number of bytes in the line, without the newline
+ * @return status code
+ */
+int Qjob::fromQueueLine(const char *line, int length) {
+  const char *token[_maxQueueTokens];
+  int tokenLength[_maxQueueTokens];
+  int nToken = 0;
+  const char *p = line;
+  const char *end = line + length;
   bool ok;
 
-  line = line.simplified();
-  QStringList lineData = line.split(" ");
-  this->_mJobNumber = lineData.value(0).toInt();
-  this->_mPriority = lineData.value(1).toDouble();
-  this->_mJobName = lineData.value(2);
-  this->_mUser = lineData.value(3);
-  this->_mStatus = this->_getJobStatus(lineData.value(4));
-  this->_mTime =
-      QDateTime::fromString(lineData.value(5), "mm/dd/yyyy hh:MM:ss");
-  this->_mTime.setDate(QDate::fromString(lineData.value(5), "mm/dd/yyyy"));
-  this->_mTime.setTime(QTime::fromString(lineData.value(6), "hh:MM:ss"));
-  this->_mTime.setTimeSpec(Qt::UTC);
-  this->_mNode = lineData.value(7);
-  this->_mNode = this->_mNode.split("@").value(1);
-  this->_mCore = this->_mNode.split(".").value(0);
-  tempInt = this->_mCore.right(3).toInt(&ok);
-  if (ok)
-    this->_mCoreNumber = tempInt;
-  else
-    this->_mCoreNumber = -1;
-  this->_mCore = this->_mCore.left(this->_mCore.length() - 3);
+  //...Split on whitespace into views of the line
+  while (nToken < _maxQueueTokens) {
+    while (p < end && _isSpace(*p))
+      p++;
+    if (p >= end)
+      break;
+    token[nToken] = p;
+    while (p < end && !_isSpace(*p))
+      p++;
+    tokenLength[nToken] = p - token[nToken];
+    nToken++;
+  }
+
+  if (nToken < 7)
+    return 1;
+
+  this->_mJobNumber = _parseInt(token[0], tokenLength[0], &ok);
+  if (!ok)
+    return 1;
+
+  this->_mPriority = _parseReal(token[1], tokenLength[1]);
+  this->_mJobName = QString::fromUtf8(token[2], tokenLength[2]);
+  this->_mUser = QString::fromUtf8(token[3], tokenLength[3]);
+  this->_mStatus = statusFromCode(token[4], tokenLength[4]);
+  this->_mTime = _parseTime(token[5], tokenLength[5], token[6], tokenLength[6]);
+
+  //...Pending jobs have no queue instance, so the column after the
+  //   time is the slot count instead of queue@host. The host is kept
+  //   whole and split by QueueIndex::splitHost, which knows the node
+  //   names and number formats of the queues
+  this->_mNode = QString();
+  if (nToken > 7) {
+    const char *at = static_cast<const char *>(
+        memchr(token[7], '@', tokenLength[7]));
+    if (at != nullptr) {
+      const char *host = at + 1;
+      const char *hostEnd = token[7] + tokenLength[7];
+      this->_mNode = QString::fromUtf8(host, hostEnd - host);
+    }
+  }
+
   return 0;
 }
 
 /**
- * @brief Qjob::_getJobStatus converts the textual status to an internal code
- * @param stat text status identifier
+ * @brief Qjob::fromRequestLine Reads one of the lines qstat -r prints below
+ * a job. The full job name and the hard queue request are kept, everything
+ * else is ignored. A request for several queues is kept as the comma
+ * separated list with the leading wildcard dropped from each entry
+ * @param line text of the line in the raw qstat output
+ * @param length number of characters in the line
+ * @return 0 if the line was a request line, 1 otherwise
+ */
+int Qjob::fromRequestLine(const char *line, int length) {
+  QByteArray text = QByteArray(line, length).trimmed();
+
+  if (text.startsWith("Full jobname:")) {
+    this->_mJobName = QString::fromUtf8(text.mid(13).trimmed());
+    return 0;
+  }
+
+  if (text.startsWith("Hard requested queues:")) {
+    QList<QByteArray> queues = text.mid(22).trimmed().split(',');
+    QStringList names;
+    for (int i = 0; i < queues.size(); i++) {
+      QByteArray name = queues[i].trimmed();
+      if (name.startsWith('*'))
+        name.remove(0, 1);
+      names << QString::fromUtf8(name);
+    }
+    this->_mQueueName = names.join(",");
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Qjob::_isSpace Checks if a character separates fields in a queue
+ * line
+ * @param c character to check
+ * @return true if the character is whitespace
+ */
+bool Qjob::_isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief Qjob::_parseInt Parses a non-negative decimal integer in place
+ * @param text pointer to the digits
+ * @param length number of characters
+ * @param ok set to false if any character is not a digit
+ * @return parsed value
+ */
+int Qjob::_parseInt(const char *text, int length, bool *ok) {
+  int value = 0;
+  *ok = length > 0;
+  for (int i = 0; i < length; i++) {
+    if (text[i] < '0' || text[i] > '9') {
+      *ok = false;
+      return 0;
+    }
+    value = value * 10 + (text[i] - '0');
+  }
+  return value;
+}
+
+/**
+ * @brief Qjob::_parseReal Parses a decimal number such as a job priority in
+ * place
+ * @param text pointer to the number
+ * @param length number of characters
+ * @return parsed value, or zero if the text is not a number
+ */
+qreal Qjob::_parseReal(const char *text, int length) {
+  qreal value = 0.0;
+  qreal scale = 1.0;
+  bool negative = false;
+  bool fraction = false;
+  int i = 0;
+
+  if (length > 0 && (text[0] == '-' || text[0] == '+')) {
+    negative = text[0] == '-';
+    i = 1;
+  }
+
+  for (; i < length; i++) {
+    if (text[i] == '.' && !fraction)
+      fraction = true;
+    else if (text[i] >= '0' && text[i] <= '9') {
+      if (fraction) {
+        scale = scale / 10.0;
+        value = value + (text[i] - '0') * scale;
+      } else
+        value = value * 10.0 + (text[i] - '0');
+    } else
+      return 0.0;
+  }
+
+  return negative ? -value : value;
+}
+
+/**
+ * @brief Qjob::_parseTime Parses the fixed format MM/dd/yyyy hh:mm:ss date
+ * and time columns in place
+ * @param date pointer to the date column
+ * @param dateLength number of characters in the date column
+ * @param time pointer to the time column
+ * @param timeLength number of characters in the time column
+ * @return date and time in UTC, invalid if the columns cannot be parsed
+ */
+QDateTime Qjob::_parseTime(const char *date, int dateLength, const char *time,
+                           int timeLength) {
+  bool ok[6];
+
+  if (dateLength != 10 || timeLength != 8 || date[2] != '/' ||
+      date[5] != '/' || time[2] != ':' || time[5] != ':')
+    return QDateTime();
+
+  int month = _parseInt(date, 2, &ok[0]);
+  int day = _parseInt(date + 3, 2, &ok[1]);
+  int year = _parseInt(date + 6, 4, &ok[2]);
+  int hour = _parseInt(time, 2, &ok[3]);
+  int minute = _parseInt(time + 3, 2, &ok[4]);
+  int second = _parseInt(time + 6, 2, &ok[5]);
+
+  for (int i = 0; i < 6; i++)
+    if (!ok[i])
+      return QDateTime();
+
+  return QDateTime(QDate(year, month, day), QTime(hour, minute, second),
+                   Qt::UTC);
+}
+
+/**
+ * @brief Qjob::_stateFlag Gives the bit for one letter of an SGE state code.
+ * The three ways a job can be suspended share one bit
+ * @param c letter from the state code
+ * @return bit for the letter, SGE_STATE_INVALID for a letter SGE never uses
+ */
+constexpr int Qjob::_stateFlag(char c) {
+  return c == 'd'   ? SGE_STATE_DELETED
+         : c == 'E' ? SGE_STATE_ERROR
+         : c == 'h' ? SGE_STATE_HOLD
+         : c == 'R' ? SGE_STATE_RESTARTED
+         : c == 'q' ? SGE_STATE_QUEUED
+         : c == 'w' ? SGE_STATE_WAITING
+         : c == 't' ? SGE_STATE_TRANSFERRING
+         : c == 'r' ? SGE_STATE_RUNNING
+         : c == 's' || c == 'S' || c == 'T' ? SGE_STATE_SUSPENDED
+                                            : SGE_STATE_INVALID;
+}
+
+/**
+ * @brief Qjob::_stateFlags Combines the bits for a whole state code. Only
+ * used to check the decoding at compile time
+ * @param stat null terminated state code
+ * @return combined bits
+ */
+constexpr int Qjob::_stateFlags(const char *stat) {
+  return *stat == 0 ? 0 : _stateFlag(*stat) | _stateFlags(stat + 1);
+}
+
+/**
+ * @brief Qjob::_statusFromFlags Maps the letters of a state code to the
+ * internal status. A deleted or failed job is reported as such whatever else
+ * it is doing, and a job that has started is never counted as held or queued
+ * @param flags combined bits of the state code
+ * @return SGE code used internally
+ */
+constexpr int Qjob::_statusFromFlags(int flags) {
+  return (flags == 0 || (flags & SGE_STATE_INVALID))
+             ? SGE_STATUS_UNKNOWN
+         : (flags & SGE_STATE_DELETED) ? SGE_STATUS_DELETED
+         : (flags & SGE_STATE_ERROR) ? SGE_STATUS_ERROR
+         : (flags & SGE_STATE_SUSPENDED) ? SGE_STATUS_SUSPENDED
+         : (flags & (SGE_STATE_RUNNING | SGE_STATE_TRANSFERRING))
+             ? SGE_STATUS_RUNNING
+         : (flags & SGE_STATE_HOLD) ? SGE_STATUS_HELD
+         : (flags & (SGE_STATE_QUEUED | SGE_STATE_WAITING))
+             ? SGE_STATUS_PENDING
+             : SGE_STATUS_UNKNOWN;
+}
+
+/**
+ * @brief Qjob::statusFromCode converts the textual status to an internal
+ * code. Each letter is decoded on its own, so any combination SGE prints is
+ * handled without comparing against a list of known codes
+ * @param code pointer to the text status identifier
+ * @param length number of characters in the status
  * @return SGE code used internally
  */
-int Qjob::_getJobStatus(QString stat) {
-  if (stat == "r" || stat == "t" || stat == "Rr" || stat == "Rt")
-    return SGE_STATUS_RUNNING;
-  else if (stat == "qw" || stat == "wq")
-    return SGE_STATUS_PENDING;
-  else if (stat == "hRqw" || stat == "hqw" || stat == "hRwq" || stat == "hwq")
-    return SGE_STATUS_HELD;
-  else if (stat == "s" || stat == "S" || stat == "ts" || stat == "tS" ||
-           stat == "T" || stat == "tT")
-    return SGE_STATUS_SUSPENDED;
-  else if (stat == "Eqw" || stat == "Ehqw" || stat == "EhRqw")
-    return SGE_STATUS_ERROR;
-  else if (stat == "dr" || stat == "dt" || stat == "dRr" || stat == "dRt" ||
-           stat == "ds" || stat == "dT" || stat == "dRs" || stat == "dRS" ||
-           stat == "dRT")
-    return SGE_STATUS_DELETED;
-  else
-    return SGE_STATUS_UNKNOWN;
+int Qjob::statusFromCode(const char *code, int length) {
+  //...The state codes qstat is known to print keep their meaning
+  static_assert(
+      _statusFromFlags(_stateFlags("r")) == SGE_STATUS_RUNNING &&
+          _statusFromFlags(_stateFlags("Rt")) == SGE_STATUS_RUNNING &&
+          _statusFromFlags(_stateFlags("qw")) == SGE_STATUS_PENDING &&
+          _statusFromFlags(_stateFlags("hRqw")) == SGE_STATUS_HELD &&
+          _statusFromFlags(_stateFlags("tS")) == SGE_STATUS_SUSPENDED &&
+          _statusFromFlags(_stateFlags("EhRqw")) == SGE_STATUS_ERROR &&
+          _statusFromFlags(_stateFlags("dRT")) == SGE_STATUS_DELETED &&
+          _statusFromFlags(_stateFlags("x")) == SGE_STATUS_UNKNOWN,
+      "SGE state codes are decoded incorrectly");
+
+  int flags = 0;
+  for (int i = 0; i < length; i++)
+    flags |= _stateFlag(code[i]);
+  return _statusFromFlags(flags);
 }
 
 /**
  * @brief Qjob::statusString Converts an internal status code to a text status
  * @return text status for the current job
  */
-QString Qjob::statusString() {
-  if (this->_mStatus == SGE_STATUS_RUNNING)
+QString Qjob::statusString() const {
+  switch (this->_mStatus) {
+  case SGE_STATUS_RUNNING:
     return QStringLiteral("r");
-  else if (this->_mStatus == SGE_STATUS_PENDING)
+  case SGE_STATUS_PENDING:
     return QStringLiteral("qw");
-  else if (this->_mStatus == SGE_STATUS_HELD)
+  case SGE_STATUS_HELD:
     return QStringLiteral("h");
-  else if (this->_mStatus == SGE_STATUS_SUSPENDED)
+  case SGE_STATUS_SUSPENDED:
     return QStringLiteral("s");
-  else if (this->_mStatus == SGE_STATUS_DELETED)
+  case SGE_STATUS_DELETED:
     return QStringLiteral("d");
-  else if (this->_mStatus == SGE_STATUS_ERROR)
+  case SGE_STATUS_ERROR:
     return QStringLiteral("e");
-  else if (this->_mStatus == SGE_STATUS_UNKNOWN)
+  default:
     return QStringLiteral("?");
-  return QStringLiteral("?");
+  }
 }
 
 /**
- * @brief Qjob::core Gets the number of cores for the current job
- * @return number of cores used in this job
+ * @brief Qjob::jobName returns the job name for this job
+ * @return job name
  */
-QString Qjob::core() { return this->_mCore; }
+QString Qjob::jobName() const { return this->_mJobName; }
 
 /**
- * @brief Qjob::coreNumber Returns the main core number in the queue line
- * @return core number from the queue line
+ * @brief Qjob::setJobName sets the current job name
+ * @param name new job name
  */
-int Qjob::coreNumber() { return this->_mCoreNumber; }
+void Qjob::setJobName(QString name) { this->_mJobName = name; }
 
 /**
- * @brief Qjob::jobName returns the job name for this job
- * @return job name
+ * @brief Qjob::queueName returns the queue name requested by this job
+ * @return queue name
  */
-QString Qjob::jobName() { return this->_mJobName; }
+QString Qjob::queueName() const { return this->_mQueueName; }
 
 /**
- * @brief Qjob::setJobName sets the current job name
- * @param name new job name
+ * @brief Qjob::setQueueName sets the queue name requested by this job
+ * @param name queue name
  */
-void Qjob::setJobName(QString name) { this->_mJobName = name; }
+void Qjob::setQueueName(QString name) { this->_mQueueName = name; }
 
 /**
  * @brief Qjob::addCoreList Adds the cores listed in the xml to the list for
@@ -148,8 +369,7 @@ void Qjob::setJobName(QString name) { this->_mJobName = name; }
  * @param core code ID to add to the list
  */
 void Qjob::addCoreList(int core) {
-  if (!this->_mNodeIds.contains(core))
-    this->_mNodeIds.append(core);
+  this->_mNodes.insert(core);
   return;
 }
 
@@ -159,49 +379,76 @@ void Qjob::addCoreList(int core) {
  * @param core core ID to check
  * @return true or false if contained (true) or not contained (false)
  */
-bool Qjob::containsCore(int core) { return this->_mNodeIds.contains(core); }
+bool Qjob::containsCore(int core) const {
+  return this->_mNodes.contains(core);
+}
+
+/**
+ * @brief Qjob::coreList Returns the list of nodes used by this job
+ * @return list of node ids
+ */
+QList<int> Qjob::coreList() const { return this->_mNodes.toList(); }
+
+/**
+ * @brief Qjob::nodeSet Returns the set of nodes used by this job
+ * @return set of node ids
+ */
+const NodeSet &Qjob::nodeSet() const { return this->_mNodes; }
+
+/**
+ * @brief Qjob::hasDetails Returns true if the job detail has been read from
+ * the scheduler or the job cache
+ * @return boolean if the job detail is known
+ */
+bool Qjob::hasDetails() const { return this->_mHasDetails; }
+
+/**
+ * @brief Qjob::setHasDetails Sets if the job detail has been read
+ * @param d boolean value denoting if the job detail is known
+ */
+void Qjob::setHasDetails(bool d) { this->_mHasDetails = d; }
 
 /**
  * @brief Qjob::jobNumber returns the job number for this job
  * @return job number
  */
-int Qjob::jobNumber() { return this->_mJobNumber; }
+int Qjob::jobNumber() const { return this->_mJobNumber; }
 
 /**
  * @brief Qjob::ncpu Returns the number of CPUs used by this job
  * @return number of CPUs used
  */
-int Qjob::ncpu() { return this->_mNcpus; }
+int Qjob::ncpu() const { return this->_mNcpus; }
 
 /**
  * @brief Qjob::priority Returns the current priority for this job
  * @return priority for this job
  */
-qreal Qjob::priority() { return this->_mPriority; }
+qreal Qjob::priority() const { return this->_mPriority; }
 
 /**
  * @brief Qjob::status Returns the current status for the job
  * @return status integer
  */
-int Qjob::status() { return this->_mStatus; }
+int Qjob::status() const { return this->_mStatus; }
 
 /**
  * @brief Qjob::node Returns the main node from the queue
  * @return String containing the core listed in the queue
  */
-QString Qjob::node() { return this->_mNode; }
+QString Qjob::node() const { return this->_mNode; }
 
 /**
  * @brief Qjob::user Returns the user for this job
  * @return user name for this job
  */
-QString Qjob::user() { return this->_mUser; }
+QString Qjob::user() const { return this->_mUser; }
 
 /**
  * @brief Qjob::time Returns the submit/start time for this job
  * @return Submit or start time for this job
  */
-QDateTime Qjob::time() { return this->_mTime; }
+QDateTime Qjob::time() const { return this->_mTime; }
 
 /**
  * @brief Qjob::addQueueHash Adds the input queue to the list of queues this job
@@ -220,7 +467,7 @@ void Qjob::addQueueHash(QByteArray hash) {
  * @param hash hash to check
  * @return true if the hash is contained, false if it is not
  */
-bool Qjob::containsQueueHash(QByteArray hash) {
+bool Qjob::containsQueueHash(QByteArray hash) const {
   return this->_mQueueHash.contains(hash);
 }
 
@@ -243,4 +490,60 @@ void Qjob::setIsOnQueue(bool q) { this->_mIsOnQueue = q; }
  * interest
  * @return boolean if the job is on the queue of user interest
  */
-bool Qjob::isOnQueue() { return this->_mIsOnQueue; }
+bool Qjob::isOnQueue() const { return this->_mIsOnQueue; }
+
+/**
+ * @brief Qjob::write Writes this job to a data stream
+ * @param stream stream to write to
+ */
+void Qjob::write(QDataStream &stream) const {
+  stream << qint32(this->_mJobNumber) << this->_mPriority << this->_mJobName
+         << this->_mUser << qint32(this->_mStatus) << this->_mTime
+         << this->_mNode << qint32(this->_mNcpus) << this->_mQueueName
+         << this->_mQueueHash << this->_mNodes.toList() << this->_mIsOnQueue
+         << this->_mHasDetails;
+  return;
+}
+
+/**
+ * @brief Qjob::read Reads this job from a data stream written with write().
+ * The lists are read one entry at a time with their sizes checked, since a
+ * snapshot may come from a peer that cannot be trusted. A list that is too
+ * long marks the stream as corrupt
+ * @param stream stream to read from
+ */
+void Qjob::read(QDataStream &stream) {
+  qint32 jobNumber, status, ncpus, node;
+  quint32 n;
+  QByteArray hash;
+
+  stream >> jobNumber >> this->_mPriority >> this->_mJobName >> this->_mUser >>
+      status >> this->_mTime >> this->_mNode >> ncpus >> this->_mQueueName;
+
+  this->_mQueueHash.clear();
+  stream >> n;
+  if (n > quint32(_maxStreamedQueues))
+    stream.setStatus(QDataStream::ReadCorruptData);
+  for (quint32 i = 0; i < n && stream.status() == QDataStream::Ok; i++) {
+    stream >> hash;
+    this->_mQueueHash.push_back(hash);
+  }
+
+  this->_mNodes.clear();
+  stream >> n;
+  if (n > quint32(_maxStreamedNodes))
+    stream.setStatus(QDataStream::ReadCorruptData);
+  for (quint32 i = 0; i < n && stream.status() == QDataStream::Ok; i++) {
+    stream >> node;
+    if (node < 0 || node >= NodeSet::maxNodeNumber)
+      stream.setStatus(QDataStream::ReadCorruptData);
+    else
+      this->_mNodes.insert(node);
+  }
+
+  stream >> this->_mIsOnQueue >> this->_mHasDetails;
+  this->_mJobNumber = jobNumber;
+  this->_mStatus = status;
+  this->_mNcpus = ncpus;
+  return;
+}
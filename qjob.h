@@ -22,14 +22,14 @@
 #ifndef QJOB_H
 #define QJOB_H
 
+#include "nodeset.h"
+#include <QDataStream>
 #include <QDateTime>
 #include <QList>
-#include <QObject>
 
-class Qjob : public QObject {
-  Q_OBJECT
+class Qjob {
 public:
-  explicit Qjob(QObject *parent = nullptr);
+  Qjob();
 
   /// Enum with various status codes for jobs
   enum _qStatus {
@@ -44,46 +44,93 @@ public:
 
   int fromQueueLine(QString line);
 
-  int jobNumber();
+  int fromQueueLine(const char *line, int length);
 
-  int ncpu();
+  int fromRequestLine(const char *line, int length);
 
-  qreal priority();
+  int jobNumber() const;
 
-  int status();
+  int ncpu() const;
 
-  QString statusString();
+  qreal priority() const;
 
-  QString node();
+  int status() const;
 
-  QString jobName();
+  QString statusString() const;
+
+  QString node() const;
+
+  QString jobName() const;
 
   void setJobName(QString name);
 
-  QString user();
+  QString queueName() const;
 
-  QDateTime time();
+  void setQueueName(QString name);
 
-  void addQueueHash(QByteArray hash);
+  QString user() const;
 
-  bool containsQueueHash(QByteArray hash);
+  QDateTime time() const;
 
-  QString core();
+  void addQueueHash(QByteArray hash);
 
-  int coreNumber();
+  bool containsQueueHash(QByteArray hash) const;
 
   void setNcpu(int n);
 
-  bool isOnQueue();
+  bool isOnQueue() const;
 
   void setIsOnQueue(bool q);
 
   void addCoreList(int core);
 
-  bool containsCore(int core);
+  bool containsCore(int core) const;
+
+  QList<int> coreList() const;
+
+  const NodeSet &nodeSet() const;
+
+  bool hasDetails() const;
+
+  void setHasDetails(bool d);
+
+  void write(QDataStream &stream) const;
+
+  void read(QDataStream &stream);
+
+  static int statusFromCode(const char *code, int length);
 
 private:
-  int _getJobStatus(QString stat);
+  /// Bits for the letters that make up an SGE state code
+  enum _qStateFlag {
+    SGE_STATE_DELETED = 0x001,
+    SGE_STATE_ERROR = 0x002,
+    SGE_STATE_HOLD = 0x004,
+    SGE_STATE_RESTARTED = 0x008,
+    SGE_STATE_QUEUED = 0x010,
+    SGE_STATE_WAITING = 0x020,
+    SGE_STATE_TRANSFERRING = 0x040,
+    SGE_STATE_RUNNING = 0x080,
+    SGE_STATE_SUSPENDED = 0x100,
+    SGE_STATE_INVALID = 0x200
+  };
+
+  static constexpr int _stateFlag(char c);
+  static constexpr int _stateFlags(const char *stat);
+  static constexpr int _statusFromFlags(int flags);
+
+  static bool _isSpace(char c);
+  static int _parseInt(const char *text, int length, bool *ok);
+  static qreal _parseReal(const char *text, int length);
+  static QDateTime _parseTime(const char *date, int dateLength,
+                              const char *time, int timeLength);
+
+  /// Number of columns read from a queue line
+  static const int _maxQueueTokens = 8;
+
+  /// Largest number of queue hashes or nodes read for a job from a stream
+  static const int _maxStreamedQueues = 10000;
+  static const int _maxStreamedNodes = 65536;
 
   /// Job number from SGE
   int _mJobNumber;
@@ -91,9 +138,6 @@ private:
   /// Number of CPUs for this job
   int _mNcpus;
 
-  /// Displayed core in the queue information
-  int _mCoreNumber;
-
   /// Job priority real
   qreal _mPriority;
 
@@ -103,15 +147,15 @@ private:
   /// Node name for this job
   QString _mNode;
 
-  /// Core string for the job
-  QString _mCore;
-
   /// User string for the job
   QString _mUser;
 
   /// Job name
   QString _mJobName;
 
+  /// Queue name requested by the job in the scheduler
+  QString _mQueueName;
+
   /// Job submit time
   QDateTime _mTime;
 
@@ -121,8 +165,13 @@ private:
   /// Logical value denoting if this job is involved in the queue of interest
   bool _mIsOnQueue;
 
-  /// List of nodes that are used for this job
-  QList<int> _mNodeIds;
+  /// Set of nodes that are used for this job
+  NodeSet _mNodes;
+
+  /// Logical value denoting if the job detail has been read from the scheduler
+  bool _mHasDetails;
 };
 
+Q_DECLARE_TYPEINFO(Qjob, Q_MOVABLE_TYPE);
+
 #endif // QJOB_H
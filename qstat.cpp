@@ -20,40 +20,94 @@
 //------------------------------------------------------------------------------
 
 #include "qstat.h"
-#include <QEventLoop>
-#include <QProcess>
+#include "queueconfig.h"
+#include "sgebackend.h"
 #include <QTextStream>
-#include <QXmlStreamReader>
+#include <cstring>
 
 /**
  * @brief Qstat::Qstat Default constructor
  * @param parent parent object pointer
  */
-Qstat::Qstat(QObject *parent) : QObject(parent) { this->_initializeQueues(); }
+Qstat::Qstat(QObject *parent) : QObject(parent) {
+  this->_mBackend = new SgeBackend(this);
+  this->_mCache = new JobCache(this);
+  this->_mUseCache = true;
+  this->_mProfiler = nullptr;
+  this->_mHistory = nullptr;
+  this->_mDeadline = 0;
+  this->_mListingHasRequests = false;
+  this->_mCacheLoaded = false;
+  this->_mIndex = new QueueIndex(this);
+  this->_mHostTable = new HostTable(this->_mIndex, this);
+  this->_initializeQueues();
+}
 
 /**
- * @brief Qstat::_initializeQueues Initializes the list of queues. Add any
- * additional queues here
+ * @brief Qstat::_initializeQueues Initializes the list of queues used when
+ * no queue definition file is given
  */
 void Qstat::_initializeQueues() {
-  this->_mQueues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_1992",
-                                     "d12chas", 20, 102, 24, 3, this));
-  this->_mQueues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_1488",
-                                     "d12chas", 41, 102, 24, 3, this));
-  this->_mQueues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_1008",
-                                     "d12chas", 41, 82, 24, 3, this));
-  this->_mQueues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_984",
-                                     "d12chas", 20, 40, 83, 102, 24, 3, this));
-  this->_mQueues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_504",
-                                     "d12chas", 20, 40, 24, 3, this));
-  this->_mQueues.push_back(
+  QVector<Queue *> queues;
+  queues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_1992", "d12chas",
+                             20, 102, 24, 3, this));
+  queues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_1488", "d12chas",
+                             41, 102, 24, 3, this));
+  queues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_1008", "d12chas",
+                             41, 82, 24, 3, this));
+  queues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_984", "d12chas",
+                             20, 40, 83, 102, 24, 3, this));
+  queues.push_back(new Queue("Aegaeon", "@@westerink_d12chas_504", "d12chas",
+                             20, 40, 24, 3, this));
+  queues.push_back(
       new Queue("Athos", "@@westerink_d6cneh", "d6cneh", 1, 83, 12, 3, this));
-  this->_mQueues.push_back(new Queue("Proteus", "@@westerink_graphics",
-                                     "proteus", 1, 2, 12, 1, this));
+  queues.push_back(new Queue("Proteus", "@@westerink_graphics", "proteus", 1,
+                             2, 12, 1, this));
+
+  this->_setQueues(queues);
+  return;
+}
+
+/**
+ * @brief Qstat::loadQueues Replaces the queues with the definitions in a
+ * file. See QueueConfig::read for the format
+ * @param filename file to read
+ * @return status code
+ */
+int Qstat::loadQueues(QString filename) {
+  QVector<Queue *> queues;
+  if (QueueConfig::read(filename, queues, this) != 0)
+    return 1;
+  if (queues.isEmpty()) {
+    QTextStream(stderr) << filename << ": no queues defined\n";
+    return 1;
+  }
+  this->_setQueues(queues);
+  return 0;
+}
 
+/**
+ * @brief Qstat::_setQueues Replaces the queues and compiles them into the
+ * lookup tables used to classify jobs and hosts
+ * @param queues new queues, owned by this object
+ */
+void Qstat::_setQueues(const QVector<Queue *> &queues) {
+  qDeleteAll(this->_mQueues);
+  this->_mQueues = queues;
+
+  //...Jobs from earlier queues would carry stale queue hashes
+  this->_mJobs.clear();
+  this->_mQueueJobs.clear();
+  this->_mAllJobs.clear();
+
+  this->_mQueueMap.clear();
   for (int i = 0; i < this->_mQueues.size(); i++)
     this->_mQueueMap[this->_mQueues[i]->hash()] = this->_mQueues[i];
 
+  //...Host states point at the old queues
+  this->_mHostTable->clear();
+
+  this->_mIndex->build(this->_mQueues);
   return;
 }
 
@@ -62,13 +116,280 @@ void Qstat::_initializeQueues() {
  * @param hash Hash for the queue of user interest
  */
 void Qstat::run(QByteArray hash) {
+  int ierr = this->collect();
+  if (ierr == 0)
+    this->display(hash);
+}
+
+/**
+ * @brief Qstat::collect Collects the job listing and the health of every
+ * queue from the scheduler. The host status, the job listing and the job
+ * details are all in flight at once and only joined here, so a collection
+ * takes as long as the slowest of them rather than their sum
+ * @return status code
+ */
+int Qstat::collect() {
+  Collection collection;
+  HostStatusParser parser([this](const HostStatusParser::Instance &instance) {
+    this->_mHostTable->setState(instance);
+  });
+
+  this->_mCollectTimer.start();
+
+  //...The cache is only read by a run that collects with it, so
+  //   replays, --no-cache and the history command never touch it
+  if (this->_mUseCache && !this->_mCacheLoaded) {
+    this->_mCache->load(JobCache::defaultFilename());
+    this->_mCacheLoaded = true;
+  }
+
+  this->_beginPhase("scheduler calls");
+  this->_startQueueHealth(&parser, &collection);
+  this->_startQueue(&collection);
+  bool finished = this->_mBackend->waitForFinished(this->_remaining());
+  this->_endPhase();
+
+  this->_finishQueueHealth(&parser, &collection);
+  this->_finishQueue(finished, &collection);
+
+  if (this->_mUseCache)
+    this->_mCache->save();
+
+  if (this->_mHistory != nullptr)
+    this->_mHistory->append(QDateTime::currentDateTimeUtc(), this->_mQueues,
+                            this->_mJobs);
+
+  return 0;
+}
+
+/**
+ * @brief Qstat::display Displays the last collected status of a queue
+ * @param hash Queue to display to the user
+ */
+void Qstat::display(QByteArray hash) { this->_displayQueue(hash); }
+
+/**
+ * @brief Qstat::_startQueueHealth Starts qstat -f -xml. Each queue instance
+ * is applied to the queues that own its host as it is read
+ * @param parser parser fed with the output
+ * @param collection collection the call belongs to
+ */
+void Qstat::_startQueueHealth(HostStatusParser *parser,
+                              Collection *collection) {
+  collection->hostStatus = 0;
+  this->_mHostTable->beginRefresh(this->_mQueues);
+  this->_mBackend->hostStatus(
+      [parser](QByteArray data) { parser->addData(data); },
+      [collection](int exitCode, QByteArray output) {
+        Q_UNUSED(output);
+        collection->hostStatus = exitCode;
+      });
+  return;
+}
+
+/**
+ * @brief Qstat::_finishQueueHealth Ends the host refresh once qstat -f -xml
+ * has been read in full
+ * @param parser parser fed with the output
+ * @param collection collection the call belongs to
+ */
+void Qstat::_finishQueueHealth(HostStatusParser *parser,
+                               Collection *collection) {
+  //...Instances that were not read keep their last state
+  //   rather than being counted as gone
+  if (collection->hostStatus == SchedulerBackend::TimedOut)
+    QTextStream(stderr) << "Warning: qstat -f did not answer in time, node "
+                           "counts are partly out of date\n";
+  else if (collection->hostStatus != 0 || parser->hasError())
+    QTextStream(stderr) << "Warning: unable to read the output of qstat -f, "
+                           "node counts are partly out of date\n";
+  else
+    this->_mHostTable->endRefresh();
+  return;
+}
+
+/**
+ * @brief Qstat::_distributeJobs Builds the list of jobs shown for each queue
+ * in a single pass over the jobs
+ */
+void Qstat::_distributeJobs() {
+  this->_mQueueJobs.clear();
+  for (int i = 0; i < this->_mJobs.size(); i++) {
+    for (int j = 0; j < this->_mQueues.size(); j++) {
+      QByteArray hash = this->_mQueues[j]->hash();
+      if (this->_mJobs[i]->containsQueueHash(hash))
+        this->_mQueueJobs[hash].push_back(this->_mJobs[i]);
+    }
+  }
+  return;
+}
+
+/**
+ * @brief Qstat::writeSnapshot Writes the queue health and the jobs in the
+ * queues to a stream so another process can display them
+ * @param stream stream to write to
+ */
+void Qstat::writeSnapshot(QDataStream &stream) {
+  stream << _snapshotMagic << _snapshotVersion
+         << QDateTime::currentDateTimeUtc();
+
+  stream << qint32(this->_mQueues.size());
   for (int i = 0; i < this->_mQueues.size(); i++)
-    if (hash == this->_mQueues[i]->hash())
-      this->_mQueues[i]->getQueueHealth();
+    stream << this->_mQueues[i]->hash() << this->_mQueues[i]->healthState();
 
-  int ierr = this->_getQueue();
-  if (ierr == 0)
-    this->_displayQueue(hash);
+  stream << qint32(this->_mJobs.size());
+  for (int i = 0; i < this->_mJobs.size(); i++)
+    this->_mJobs[i]->write(stream);
+
+  return;
+}
+
+/**
+ * @brief Qstat::readSnapshot Replaces the current jobs and queue health with
+ * a snapshot written by writeSnapshot(). Jobs are matched to queues by their
+ * hashes, so a snapshot is only taken if it holds every queue defined here
+ * @param stream stream to read from
+ * @return status code, 2 if the snapshot was collected for other queues
+ */
+int Qstat::readSnapshot(QDataStream &stream) {
+  quint32 magic, version;
+  qint32 n;
+  QDateTime collected;
+  QByteArray hash, state;
+  QHash<QByteArray, QByteArray> states;
+  QVector<Qjob> jobs;
+  Qjob job;
+
+  stream >> magic >> version >> collected;
+  if (stream.status() != QDataStream::Ok || magic != _snapshotMagic ||
+      version != _snapshotVersion)
+    return 1;
+
+  //...The counts come from a socket any local user can write to,
+  //   so they are checked before anything is sized from them
+  stream >> n;
+  if (stream.status() != QDataStream::Ok || n < 0 ||
+      n > _maxSnapshotQueues)
+    return 1;
+
+  for (int i = 0; i < n; i++) {
+    stream >> hash >> state;
+    if (stream.status() != QDataStream::Ok)
+      return 1;
+    states.insert(hash, state);
+  }
+
+  //...A daemon reading other queue definitions would leave every
+  //   queue without jobs, so nothing is taken from its snapshot
+  for (int i = 0; i < this->_mQueues.size(); i++)
+    if (!states.contains(this->_mQueues[i]->hash()))
+      return 2;
+
+  stream >> n;
+  if (stream.status() != QDataStream::Ok || n < 0 || n > _maxSnapshotJobs)
+    return 1;
+
+  //...Jobs are only stored once they have been read, so a short
+  //   stream never costs more than the data it holds
+  for (int i = 0; i < n; i++) {
+    job.read(stream);
+    if (stream.status() != QDataStream::Ok)
+      return 1;
+    jobs.push_back(job);
+  }
+
+  //...The counters now come from the snapshot, not the table
+  this->_mHostTable->clear();
+  for (int i = 0; i < this->_mQueues.size(); i++)
+    this->_mQueues[i]->setHealthState(states[this->_mQueues[i]->hash()]);
+
+  this->_mAllJobs.swap(jobs);
+  this->_selectJobs();
+
+  for (int i = 0; i < this->_mJobs.size(); i++)
+    this->_classified(*this->_mJobs[i]);
+
+  return 0;
+}
+
+/**
+ * @brief Qstat::setUseCache Sets if the on-disk job detail cache is used
+ * @param useCache true if the cache should be used
+ */
+void Qstat::setUseCache(bool useCache) { this->_mUseCache = useCache; }
+
+/**
+ * @brief Qstat::useCache Returns if the on-disk job detail cache is used
+ * @return true if the cache is used
+ */
+bool Qstat::useCache() { return this->_mUseCache; }
+
+/**
+ * @brief Qstat::setMaxProcesses Sets the maximum number of qstat processes
+ * that may run at the same time
+ * @param maxProcesses maximum number of processes
+ */
+void Qstat::setMaxProcesses(int maxProcesses) {
+  this->_mBackend->setMaxProcesses(maxProcesses);
+}
+
+/**
+ * @brief Qstat::setBackend Replaces the backend used to reach the scheduler.
+ * The concurrency limit and timeout carry over to the new backend
+ * @param backend new backend, ownership is taken
+ */
+void Qstat::setBackend(SchedulerBackend *backend) {
+  backend->setMaxProcesses(this->_mBackend->maxProcesses());
+  backend->setTimeout(this->_mBackend->timeout());
+  backend->setParent(this);
+  delete this->_mBackend;
+  this->_mBackend = backend;
+}
+
+/**
+ * @brief Qstat::setTimeout Sets the time a single scheduler call may take
+ * before it is stopped
+ * @param msec time in milliseconds, 0 for no limit
+ */
+void Qstat::setTimeout(int msec) { this->_mBackend->setTimeout(msec); }
+
+/**
+ * @brief Qstat::setDeadline Sets the time a whole collection may take. Calls
+ * still outstanding at the deadline are stopped and whatever arrived in time
+ * is shown
+ * @param msec time in milliseconds, 0 for no limit
+ */
+void Qstat::setDeadline(int msec) { this->_mDeadline = msec < 0 ? 0 : msec; }
+
+/**
+ * @brief Qstat::_remaining Returns the time left before the deadline of the
+ * current collection
+ * @return time in milliseconds, -1 if there is no deadline
+ */
+int Qstat::_remaining() {
+  if (this->_mDeadline == 0)
+    return -1;
+  return qMax(qint64(0), this->_mDeadline - this->_mCollectTimer.elapsed());
+}
+
+/**
+ * @brief Qstat::_isCandidate Checks if a job could be in one of the queues
+ * and needs its details. Running jobs are only candidates when their main
+ * node is in a queue. Queued jobs are candidates when they request one of
+ * the queues, or always when the listing does not carry the requests
+ * @param job job from the listing
+ * @return true if the details of the job are needed
+ */
+bool Qstat::_isCandidate(Qjob *job) {
+  if (job->status() == Qjob::SGE_STATUS_RUNNING)
+    return this->_mIndex->isOnNodes(job);
+
+  //...Without the requests in the listing any queued job may be ours
+  if (!this->_mListingHasRequests)
+    return true;
+
+  //...Queued jobs can only be shown in a queue they asked for
+  return !this->_mIndex->queuesRequested(job->queueName()).isEmpty();
 }
 
 /**
@@ -77,6 +398,20 @@ void Qstat::run(QByteArray hash) {
  */
 int Qstat::numQueues() { return this->_mQueues.size(); }
 
+/**
+ * @brief Qstat::numJobs Gets the number of jobs held from the last
+ * collection
+ * @return number of jobs held
+ */
+int Qstat::numJobs() { return this->_mAllJobs.size(); }
+
+/**
+ * @brief Qstat::queueIndex Returns the lookup from hosts and queue names to
+ * the queues, as used to classify jobs
+ * @return pointer to the queue index
+ */
+QueueIndex *Qstat::queueIndex() { return this->_mIndex; }
+
 /**
  * @brief Qstat::queue Returns a pointer to a queue
  * @param index position in list of queues displayed to user
@@ -84,247 +419,367 @@ int Qstat::numQueues() { return this->_mQueues.size(); }
  */
 Queue *Qstat::queue(int index) { return this->_mQueues[index]; }
 
+/**
+ * @brief Qstat::queue Returns a pointer to a queue by name. The leading @@ of
+ * a host group name may be left off
+ * @param queueName name of the queue
+ * @return pointer to a queue, or nullptr if there is no such queue
+ */
+Queue *Qstat::queue(QString queueName) {
+  for (int i = 0; i < this->_mQueues.size(); i++)
+    if (this->_mQueues[i]->queueName() == queueName ||
+        this->_mQueues[i]->queueName() == "@@" + queueName)
+      return this->_mQueues[i];
+  return nullptr;
+}
+
 /**
  * @brief Qstat::_displayQueue Displayes the queue status to the user
  * @param hash Queue to display to the user
  */
 void Qstat::_displayQueue(QByteArray hash) {
-  int nJobs = 0;
-  QTextStream output(stdout);
-  output << "\n";
+  Queue *queue = this->_mQueueMap.value(hash, nullptr);
+  if (queue == nullptr)
+    return;
+  this->_beginPhase("display");
+  this->_mRenderer.appendQueue(queue, this->_mQueueJobs.value(hash));
+  this->_mRenderer.write();
+  this->_endPhase();
+  return;
+}
+
+/**
+ * @brief Qstat::_startQueue Starts qstat. The details of the jobs it lists
+ * are asked for as soon as the listing has been read
+ * @param collection collection the call belongs to
+ */
+void Qstat::_startQueue(Collection *collection) {
+  collection->listingTimedOut = false;
+  this->_mBackend->listJobs(
+      this->_queueFilter(),
+      [this, collection](int exitCode, QByteArray output) {
+        if (exitCode == SchedulerBackend::TimedOut)
+          collection->listingTimedOut = true;
+        else
+          this->_parseListing(output, collection);
+      });
+  return;
+}
+
+/**
+ * @brief Qstat::_queueFilter Returns the queues running jobs are listed
+ * from. A host group selects every queue instance on its hosts, which are
+ * the nodes the queues are classified by, so running jobs anywhere else
+ * are left out of the listing. A queue named after a cluster queue would
+ * select fewer jobs than its nodes hold, so then every job is listed
+ * @return queues in qstat -q form, empty to list every job
+ */
+QStringList Qstat::_queueFilter() {
+  QStringList queues;
   for (int i = 0; i < this->_mQueues.size(); i++) {
-    if (this->_mQueues[i]->hash() == hash) {
-      output << QString(_cyan + "Machine:" + _reset + " %1 \n " + _cyan +
-                        " Queue:" + _reset + " %2")
-                    .arg(this->_mQueues[i]->machine())
-                    .arg(this->_mQueues[i]->queueName())
-             << "\n";
-      output << _cyan
-             << "|-------------------------------------------------------------"
-                "-------------------|\n";
-      output << _cyan
-             << "|   JID    |            Job Name            |    User    |   "
-                "Status  |   Cores   |\n";
-      output << _cyan
-             << "|-------------------------------------------------------------"
-                "-------------------|\n";
-      for (int j = 0; j < this->_mJobs.length(); j++) {
-        if (this->_mJobs[j]->containsQueueHash(this->_mQueues[i]->hash())) {
-          nJobs = nJobs + 1;
-          output << this->_formatJobOutputLine(this->_mJobs[j]);
-        }
-      }
-      output << _cyan
-             << "|-------------------------------------------------------------"
-                "-------------------|\n";
-      output.flush();
-      output << "\n" << _reset;
-      output << "SYSTEM STATUS"
-             << "\n";
-      output << "   RUNNING JOBS: " << nJobs << "\n\n";
-      output.flush();
-      this->_displayQueueHealth(this->_mQueues[i]);
-      output << "Note: Jobs that fall between multiple queues are shown \n"
-                "in each queue they use resources from.\n";
-      output.flush();
-      return;
+    QString name = this->_mQueues[i]->queueName();
+    if (!name.startsWith("@@"))
+      return QStringList();
+    if (!queues.contains("*" + name))
+      queues << "*" + name;
+  }
+  return queues;
+}
+
+/**
+ * @brief Qstat::_parseListing Parses the output of qstat and starts the
+ * detail lookups. Jobs from the previous call that are listed again in the
+ * same state are reused as they are, so only new or changed jobs are looked
+ * up in detail
+ * @param output raw output from qstat
+ * @param collection collection the listing belongs to
+ */
+void Qstat::_parseListing(const QByteArray &output, Collection *collection) {
+  Qjob tempJob;
+  QVector<Qjob> allJobs;
+  QVector<int> newIndex;
+  QVector<Qjob *> candidates;
+  QMultiHash<int, int> previousJobs;
+  int oldJob;
+  int nRequests;
+
+  this->_beginPhase("parse job listing");
+
+  for (int i = 0; i < this->_mAllJobs.size(); i++)
+    previousJobs.insert(this->_mAllJobs[i].jobNumber(), i);
+
+  //...qstat -r prints the requests on lines below each job, so
+  //   count the jobs by their name line when it is there
+  nRequests = output.count("Full jobname:");
+  this->_mListingHasRequests = nRequests > 0;
+
+  //...Jobs are stored by value in one block sized for the listing
+  allJobs.reserve(nRequests > 0 ? nRequests : output.count('\n'));
+
+  //...Loop over the job list in the raw output and save the
+  //   ones that could matter. The first two lines are the header
+  const char *line = output.constData();
+  const char *end = line + output.size();
+  for (int lineNumber = 0; line < end; lineNumber++) {
+    const char *eol =
+        static_cast<const char *>(memchr(line, '\n', end - line));
+    if (eol == nullptr)
+      eol = end;
+
+    const char *start = line;
+    line = eol + 1;
+
+    if (lineNumber < 2)
+      continue;
+
+    tempJob = Qjob();
+    if (tempJob.fromQueueLine(start, eol - start) != 0) {
+      //...Request lines belong to the job listed above them
+      if (!newIndex.isEmpty() && newIndex.last() == allJobs.size() - 1)
+        allJobs.last().fromRequestLine(start, eol - start);
+      continue;
     }
+
+    //...Jobs still missing their details are asked for again
+    oldJob = this->_takeMatchingJob(previousJobs, tempJob);
+    if (oldJob >= 0 && (this->_mAllJobs[oldJob].hasDetails() ||
+                        !this->_isCandidate(&this->_mAllJobs[oldJob]))) {
+      allJobs.push_back(this->_mAllJobs[oldJob]);
+      this->_classified(allJobs.last());
+      continue;
+    }
+
+    newIndex.push_back(allJobs.size());
+    allJobs.push_back(tempJob);
   }
+
+  //...Replacing the storage frees every job that has finished
+  //   or changed state in one step
+  this->_mAllJobs.swap(allJobs);
+  this->_endPhase();
+
+  //...Forget cached detail for jobs that have left the scheduler
+  if (this->_mUseCache)
+    this->_mCache->retain(this->_mAllJobs);
+
+  //...Ask for the details of all candidate jobs in as few
+  //   calls to the scheduler as possible. The requests of a new
+  //   job are only known once its request lines have been read
+  candidates.reserve(newIndex.size());
+  for (int i = 0; i < newIndex.size(); i++)
+    if (this->_isCandidate(&this->_mAllJobs[newIndex[i]]))
+      candidates.push_back(&this->_mAllJobs[newIndex[i]]);
+  this->_startDetails(candidates, collection);
+
   return;
 }
 
 /**
- * @brief Qstat::_formatJobOutputLine Formats the job data into a formatted
- * string
- * @param job job pointer to be formatted
- * @return Formatted string
+ * @brief Qstat::_finishQueue Reports the jobs that could not be collected
+ * in time and builds the job list for each queue
+ * @param finished false if the deadline cut off some scheduler calls
+ * @param collection collection to finish
  */
-QString Qstat::_formatJobOutputLine(Qjob *job) {
-  QString user = QProcessEnvironment::systemEnvironment().value("USER");
-  QString jobnum, jobname, username, status, ncpu;
-
-  jobnum.sprintf("%7.7s",
-                 QString::number(job->jobNumber()).toStdString().c_str());
-  jobname.sprintf("%30.30s", job->jobName().toStdString().c_str());
-  username.sprintf("%10.10s", job->user().toStdString().c_str());
-  status.sprintf("%9.9s", job->statusString().toStdString().c_str());
-  ncpu.sprintf("%9.9s", QString::number(job->ncpu()).toStdString().c_str());
+void Qstat::_finishQueue(bool finished, Collection *collection) {
+  //...A cut off listing would drop jobs, so show the last one
+  if (collection->listingTimedOut) {
+    QTextStream(stderr) << "Warning: qstat did not answer in time, the job "
+                           "list is not up to date\n";
+    for (int i = 0; i < this->_mJobs.size(); i++)
+      this->_classified(*this->_mJobs[i]);
+    return;
+  }
 
-  QString output;
-  output = _cyan + "| " + _reset + jobnum;
-  output = output + _cyan + "  | " + _reset + jobname;
+  if (!finished) {
+    int incomplete = 0;
+    for (QMap<int, QVector<Qjob *> >::iterator it =
+             collection->jobMap.begin();
+         it != collection->jobMap.end(); ++it)
+      for (int i = 0; i < it.value().size(); i++)
+        if (!it.value()[i]->hasDetails())
+          incomplete++;
+    if (incomplete > 0)
+      QTextStream(stderr) << "Warning: " << incomplete
+                          << " job(s) did not return their details in time\n";
+  }
+  qDeleteAll(collection->detailParsers);
+  collection->detailParsers.clear();
 
-  if (job->user() == user)
-    output = output + _cyan + " | " + _red + username;
-  else
-    output = output + _cyan + " | " + _reset + username;
+  //...Save the new detail for later runs
+  if (this->_mUseCache)
+    for (QMap<int, QVector<Qjob *> >::iterator it =
+             collection->jobMap.begin();
+         it != collection->jobMap.end(); ++it)
+      for (int i = 0; i < it.value().size(); i++)
+        this->_mCache->insert(it.value()[i]);
 
-  if (job->status() == Qjob::SGE_STATUS_RUNNING)
-    output = output + _cyan + " | " + _green + status;
-  else if (job->status() == Qjob::SGE_STATUS_PENDING)
-    output = output + _cyan + " | " + _yellow + status;
-  else if (job->status() == Qjob::SGE_STATUS_HELD)
-    output = output + _cyan + " | " + _magenta + status;
-  else if (job->status() == Qjob::SGE_STATUS_ERROR)
-    output = output + _cyan + " | " + _red + status;
-  else
-    output = output + _cyan + " | " + _reset + status;
+  this->_beginPhase("classification");
+  this->_selectJobs();
+  this->_endPhase();
 
-  output = output + _cyan + " | " + _reset + ncpu;
-  output = output + _cyan + " | \n";
-  return output;
+  return;
 }
 
 /**
- * @brief Qstat::_displayQueueHealth Prints the current health of the queue
- * @param q queue for which to print the health to the screen
- */
-void Qstat::_displayQueueHealth(Queue *q) {
-  QTextStream output(stdout);
-  output << "    TOTAL CORES: " << q->queueTotalCores() << "\n";
-  output << "    AVAIL CORES: " << q->queueFreeCores() << "\n";
-  output << "  RUNNING CORES: " << q->queueRunningCores() << "\n";
-  output << "\n";
-  output << "    TOTAL NODES: " << q->queueTotalNodes() << "\n";
-  output << "       UP NODES: " << q->queueUpNodes() << "\n";
-  output << "     DOWN NODES: " << q->queueDownNodes() << "\n";
-  output << "     IDLE NODES: " << q->queueIdleNodes() << "\n";
-  output << "\n";
-  output.flush();
+ * @brief Qstat::_selectJobs Builds the list of jobs that are in any queue
+ * and groups them by queue. The pointers refer into the job storage and are
+ * rebuilt whenever the storage is replaced
+ */
+void Qstat::_selectJobs() {
+  this->_mJobs.clear();
+  for (int i = 0; i < this->_mAllJobs.size(); i++)
+    if (this->_mAllJobs[i].isOnQueue())
+      this->_mJobs.push_back(&this->_mAllJobs[i]);
+  this->_distributeJobs();
   return;
 }
 
 /**
- * @brief Qstat::_getQueue Runs qstat and parses the XML return data
- * @return status code
+ * @brief Qstat::_takeMatchingJob Finds a job from the previous listing that
+ * is the same job in the same state as the new listing line and removes it
+ * from the list of previous jobs
+ * @param previousJobs positions of the jobs from the previous listing by job
+ * number
+ * @param job job read from the new listing
+ * @return position of the previous job, or -1 if there is no match
  */
-int Qstat::_getQueue() {
-
-  QString cmd = "qstat";
-  QEventLoop loop;
-  QProcess command(this);
-  Qjob *tempJob;
-
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.insert("IFS", "");
-
-  command.start(cmd);
-  command.setEnvironment(env.toStringList());
-  connect(&command, SIGNAL(finished(int, QProcess::ExitStatus)), &loop,
-          SLOT(quit()));
-  loop.exec();
-
-  //...Read the output from the blanket qstat command
-  QStringList queueData = QString(command.readAllStandardOutput()).split("\n");
-
-  //...Loop over the job list and save the ones
-  //   that matter
-  for (int i = 2; i < queueData.size() - 1; i++) {
-    tempJob = new Qjob(this);
-    tempJob->fromQueueLine(queueData.at(i));
-
-    //...If running, check if the job is possibly in one of
-    //   our queues of interest. Speeds up code.
-    //   Queued jobs are still always checked
-    if (tempJob->status() == Qjob::SGE_STATUS_RUNNING) {
-      for (int j = 0; j < this->_mQueues.size(); j++) {
-        if (this->_mQueues[j]->isOnNodes(tempJob)) {
-          this->_getXML(tempJob);
-          if (tempJob->isOnQueue()) {
-            this->_mJobs.push_back(tempJob);
-            break;
-          }
-        }
-      }
-    } else {
-      this->_getXML(tempJob);
-      if (tempJob->isOnQueue()) {
-        this->_mJobs.push_back(tempJob);
-        continue;
-      }
+int Qstat::_takeMatchingJob(QMultiHash<int, int> &previousJobs,
+                            const Qjob &job) {
+  QMultiHash<int, int>::iterator it = previousJobs.find(job.jobNumber());
+  while (it != previousJobs.end() && it.key() == job.jobNumber()) {
+    const Qjob &oldJob = this->_mAllJobs.at(it.value());
+    if (oldJob.status() == job.status() && oldJob.time() == job.time() &&
+        oldJob.node() == job.node()) {
+      int index = it.value();
+      previousJobs.erase(it);
+      return index;
     }
+    ++it;
   }
-
-  return 0;
+  return -1;
 }
 
 /**
- * @brief Qstat::_getXML Runs qstat with xml output for additional job detail
- * @param testJob job to get the output for
- * @return status code
+ * @brief Qstat::_startDetails Starts qstat with xml output for additional
+ * job detail. Jobs found in the job cache are skipped and the rest are
+ * requested in batches so that the number of processes spawned does not
+ * grow with the number of jobs
+ * @param jobs list of jobs to get the output for
+ * @param collection collection the calls belong to
  */
-int Qstat::_getXML(Qjob *testJob) {
-  QString queueName, jobName, coreName;
-  int nCore = 0;
-  bool ok, foundCoreCount;
-
-  QString cmd = "qstat -xml -j " + QString::number(testJob->jobNumber());
-
-  QEventLoop loop;
-  QProcess command(this);
-
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.insert("IFS", "");
-
-  command.start(cmd);
-  command.setEnvironment(env.toStringList());
-  connect(&command, SIGNAL(finished(int, QProcess::ExitStatus)), &loop,
-          SLOT(quit()));
-  loop.exec();
-
-  QString data = command.readAllStandardOutput();
-
-  QXmlStreamReader xmlParser(data);
-
-  foundCoreCount = false;
-
-  //...Loop over xml elements
-  while (!xmlParser.atEnd() && !xmlParser.hasError()) {
-    QXmlStreamReader::TokenType token = xmlParser.readNext();
-    if (token == QXmlStreamReader::StartElement) {
-      if (xmlParser.name() == "QR_name") {
-        queueName = xmlParser.readElementText();
-        if (queueName.left(1) == "*")
-          queueName = queueName.right(queueName.length() - 1);
-      } else if (xmlParser.name() == "RN_max" && !foundCoreCount) {
-        foundCoreCount = true;
-        nCore = xmlParser.readElementText().toInt();
-      } else if (xmlParser.name() == "JB_job_name")
-        jobName = xmlParser.readElementText();
-      else if (xmlParser.name() == "PET_id") {
-        coreName = xmlParser.readElementText().split(".").value(1);
-        testJob->addCoreList(coreName.right(3).toInt(&ok));
-        if (!ok)
-          testJob->addCoreList(coreName.right(1).toInt(&ok));
-      } else if (xmlParser.name() == "JG_qhostname") {
-        coreName = xmlParser.readElementText().split(".").value(0);
-        testJob->addCoreList(coreName.right(3).toInt(&ok));
-        if (!ok)
-          testJob->addCoreList(coreName.right(1).toInt(&ok));
-      }
+void Qstat::_startDetails(QVector<Qjob *> &jobs, Collection *collection) {
+  QMap<int, QVector<Qjob *> > &jobMap = collection->jobMap;
+  QStringList jobIds;
+
+  //...Array jobs show up once per task, so only ask for each
+  //   job number once and apply the result to every task
+  for (int i = 0; i < jobs.size(); i++) {
+    if (this->_mUseCache && this->_mCache->lookup(jobs[i])) {
+      this->_findQueue(jobs[i]);
+      this->_classified(*jobs[i]);
+      continue;
     }
+    int jobNumber = jobs[i]->jobNumber();
+    if (!jobMap.contains(jobNumber))
+      jobIds.push_back(QString::number(jobNumber));
+    jobMap[jobNumber].push_back(jobs[i]);
   }
 
-  //...Set the job info and locate the queue
-  testJob->setNcpu(nCore);
-  testJob->setJobName(jobName);
-  this->_findQueue(testJob, queueName);
+  //...Split the ids so that every available process has work,
+  //   but never put more than the maximum in a single call
+  int batchSize = (jobIds.size() + this->_mBackend->maxProcesses() - 1) /
+                  this->_mBackend->maxProcesses();
+  batchSize = qBound(1, batchSize, this->_maxJobsPerQuery);
+
+  //...Each batch gets its own parser, fed from the pipe as the
+  //   scheduler writes so parsing overlaps the query
+  for (int i = 0; i < jobIds.size(); i += batchSize) {
+    QStringList batch = jobIds.mid(i, batchSize);
+    JobDetailParser *parser = new JobDetailParser(&jobMap, this->_mIndex);
+    collection->detailParsers.push_back(parser);
+    this->_mBackend->jobDetails(
+        batch, [parser](QByteArray data) { parser->addData(data); },
+        [this, batch, &jobMap](int exitCode, QByteArray output) {
+          Q_UNUSED(exitCode);
+          Q_UNUSED(output);
+          //...Locate the queues for each job as soon as its
+          //   batch is complete
+          this->_beginPhase("classification");
+          for (int j = 0; j < batch.size(); j++) {
+            const QVector<Qjob *> &batchJobs = jobMap[batch[j].toInt()];
+            for (int k = 0; k < batchJobs.size(); k++) {
+              this->_findQueue(batchJobs[k]);
+              this->_classified(*batchJobs[k]);
+            }
+          }
+          this->_endPhase();
+        });
+  }
+  return;
+}
 
-  return 0;
+/**
+ * @brief Qstat::setJobCallback Sets a function called for every job in one
+ * of the queues as soon as its queues are known, before the collection has
+ * finished
+ * @param callback function to call, or an empty function for none
+ */
+void Qstat::setJobCallback(JobCallback callback) {
+  this->_mJobCallback = callback;
+}
+
+/**
+ * @brief Qstat::setProfiler Sets the profiler that the time spent in each
+ * phase of a collection is reported to
+ * @param profiler profiler to report to, or nullptr for none
+ */
+void Qstat::setProfiler(Profiler *profiler) { this->_mProfiler = profiler; }
+
+/**
+ * @brief Qstat::setHistory Sets the log that every collection is appended to
+ * @param history log to append to, or nullptr for none
+ */
+void Qstat::setHistory(HistoryLog *history) { this->_mHistory = history; }
+
+/**
+ * @brief Qstat::_beginPhase Starts timing a phase if profiling
+ * @param name name of the phase
+ */
+void Qstat::_beginPhase(QString name) {
+  if (this->_mProfiler != nullptr)
+    this->_mProfiler->begin(name);
+  return;
+}
+
+/**
+ * @brief Qstat::_endPhase Ends the phase started last if profiling
+ */
+void Qstat::_endPhase() {
+  if (this->_mProfiler != nullptr)
+    this->_mProfiler->end();
+  return;
+}
+
+/**
+ * @brief Qstat::_classified Reports a job whose queues are known
+ * @param job job that has been classified
+ */
+void Qstat::_classified(const Qjob &job) {
+  if (this->_mJobCallback && job.isOnQueue())
+    this->_mJobCallback(job);
+  return;
 }
 
 /**
  * @brief Qstat::_findQueue Finds the queues that a job participates in
  * @param testJob pointer to a job
- * @param queueName name of the queue to check
  * @return status code
  */
-int Qstat::_findQueue(Qjob *testJob, QString queueName) {
-  for (int i = 0; i < this->_mQueues.size(); i++) {
-    if (this->_mQueues[i]->isInQueue(testJob, queueName)) {
-      testJob->addQueueHash(this->_mQueues[i]->hash());
-      testJob->setIsOnQueue(true);
-    }
+int Qstat::_findQueue(Qjob *testJob) {
+  QVector<Queue *> queues = this->_mIndex->queuesForJob(testJob);
+  for (int i = 0; i < queues.size(); i++) {
+    testJob->addQueueHash(queues[i]->hash());
+    testJob->setIsOnQueue(true);
   }
   return 0;
 }
@@ -22,52 +22,166 @@
 #ifndef QSTAT_H
 #define QSTAT_H
 
+#include "jobcache.h"
+#include "historylog.h"
+#include "hoststatusparser.h"
+#include "hosttable.h"
+#include "jobdetailparser.h"
+#include "profiler.h"
 #include "qjob.h"
 #include "queue.h"
+#include "queueindex.h"
+#include "schedulerbackend.h"
+#include "tablerenderer.h"
+#include <QDataStream>
+#include <QHash>
+#include <QElapsedTimer>
 #include <QMap>
+#include <QMultiHash>
 #include <QObject>
 #include <QVector>
+#include <functional>
 
 class Qstat : public QObject {
   Q_OBJECT
 public:
+  /// Function called with each job once its queues are known
+  typedef std::function<void(const Qjob &job)> JobCallback;
+
   explicit Qstat(QObject *parent = nullptr);
 
   void run(QByteArray hash);
 
+  int collect();
+
+  void display(QByteArray hash);
+
+  void writeSnapshot(QDataStream &stream);
+
+  int readSnapshot(QDataStream &stream);
+
+  void setMaxProcesses(int maxProcesses);
+
+  void setBackend(SchedulerBackend *backend);
+
+  void setTimeout(int msec);
+
+  void setDeadline(int msec);
+
+  int loadQueues(QString filename);
+
+  void setJobCallback(JobCallback callback);
+
+  void setProfiler(Profiler *profiler);
+
+  void setHistory(HistoryLog *history);
+
+  void setUseCache(bool useCache);
+
+  bool useCache();
+
   int numQueues();
+  int numJobs();
+  QueueIndex *queueIndex();
   Queue *queue(int index);
+  Queue *queue(QString queueName);
 
 private:
-  //...Color codes for unix terminal display
-  const QString _cyan = "\E[36m";
-  const QString _black = "\E[30;47m";
-  const QString _red = "\E[31m";
-  const QString _green = "\E[32m";
-  const QString _yellow = "\E[33m";
-  const QString _blue = "\E[34m";
-  const QString _magenta = "\E[35m";
-  const QString _white = "\E[37m";
-  const QString _reset = "\E[0m";
+  //...Maximum number of job ids sent to a single qstat -j call
+  const int _maxJobsPerQuery = 500;
+
+  //...Identifiers written at the start of a snapshot
+  const quint32 _snapshotMagic = 0x51565350;
+  const quint32 _snapshotVersion = 2;
+
+  //...Largest number of queues or jobs accepted from a snapshot
+  const qint32 _maxSnapshotQueues = 10000;
+  const qint32 _maxSnapshotJobs = 1000000;
+
+  /// Scheduler calls of one collection, read once they have all finished
+  struct Collection {
+    int hostStatus;
+    bool listingTimedOut;
+    QMap<int, QVector<Qjob *> > jobMap;
+    QVector<JobDetailParser *> detailParsers;
+  };
 
   int _parseQstat();
   int _getJobInfo();
-  int _getQueue();
+  void _startQueue(Collection *collection);
+  QStringList _queueFilter();
+  void _parseListing(const QByteArray &output, Collection *collection);
+  void _finishQueue(bool finished, Collection *collection);
+  void _startQueueHealth(HostStatusParser *parser, Collection *collection);
+  void _finishQueueHealth(HostStatusParser *parser, Collection *collection);
+  void _distributeJobs();
+  int _takeMatchingJob(QMultiHash<int, int> &previousJobs, const Qjob &job);
+  void _selectJobs();
   void _displayQueue(QByteArray hash);
-  void _displayQueueHealth(Queue *q);
   void _initializeQueues();
-  int _getXML(Qjob *testJob);
-  int _findQueue(Qjob *testJob, QString queueName);
-  QString _formatJobOutputLine(Qjob *job);
+  void _setQueues(const QVector<Queue *> &queues);
+  void _startDetails(QVector<Qjob *> &jobs, Collection *collection);
+  int _findQueue(Qjob *testJob);
+  void _classified(const Qjob &job);
+  void _beginPhase(QString name);
+  void _endPhase();
+  int _remaining();
+  bool _isCandidate(Qjob *job);
+
+  /// Backend used for all scheduler calls
+  SchedulerBackend *_mBackend;
+
+  /// Cache of job details that do not change while a job is alive
+  JobCache *_mCache;
+
+  /// Logical value denoting if the job cache is used
+  bool _mUseCache;
+
+  /// Logical value denoting if the job cache has been read from disk
+  bool _mCacheLoaded;
+
+  /// True if the last listing carried the requests of each job (qstat -r)
+  bool _mListingHasRequests;
+
+  /// Time a whole collection may take in milliseconds, 0 for no limit
+  int _mDeadline;
+
+  /// Time since the current collection started
+  QElapsedTimer _mCollectTimer;
 
   /// List of queues that the user can select from
   QVector<Queue *> _mQueues;
 
+  /// Lookup from nodes and queue names to the queues that own them
+  QueueIndex *_mIndex;
+
   /// Mapping from a queue hash to a pointer to the queue
   QMap<QByteArray, Queue *> _mQueueMap;
 
-  /// Vector of the jobs in each queue
+  /// Last known state of every queue instance, as counted in the queues
+  HostTable *_mHostTable;
+
+  /// Vector of the jobs in any queue, pointing into _mAllJobs
   QVector<Qjob *> _mJobs;
+
+  /// Mapping from a queue hash to the jobs shown in that queue
+  QMap<QByteArray, QVector<Qjob *> > _mQueueJobs;
+
+  /// Function called with each job once its queues are known
+  JobCallback _mJobCallback;
+
+  /// Profiler the phases are reported to, or nullptr
+  Profiler *_mProfiler;
+
+  /// Log each collection is appended to, or nullptr
+  HistoryLog *_mHistory;
+
+  /// Renderer for the job tables
+  TableRenderer _mRenderer;
+
+  /// Every job in the last qstat listing, stored by value. Never copied so
+  /// that pointers in _mJobs stay valid until it is replaced
+  QVector<Qjob> _mAllJobs;
 };
 
 #endif // QSTAT_H
@@ -20,34 +20,27 @@
 //------------------------------------------------------------------------------
 
 #include "queue.h"
-#include <QEventLoop>
-#include <QProcess>
-#include <QStringList>
+#include <QDataStream>
 
 /**
  * @brief Queue::Queue Default constructor
  * @param machineName Name of machine
  * @param queueName Name of queue
  * @param queueCore Name of cores
- * @param queueStart Start index for queue
- * @param queueEnd End index for queue
+ * @param nodeRanges First and last node of each range of nodes
  * @param coreSize Number of processors on each core
- * @param nameFormat Number of digits in each core
+ * @param nameFormat Number of digits in each core, 0 if not padded
  * @param parent Pointer to parent object
  */
 Queue::Queue(QString machineName, QString queueName, QString queueCore,
-             int queueStart, int queueEnd, int coreSize, int nameFormat,
-             QObject *parent)
+             QVector<QPair<int, int> > nodeRanges, int coreSize,
+             int nameFormat, QObject *parent)
     : QObject(parent) {
   this->_mMachineName = machineName;
   this->_mQueueName = queueName;
   this->_mNodeName = queueCore;
-  this->_mNodeStart = queueStart;
-  this->_mNodeEnd = queueEnd;
+  this->_mNodeRanges = nodeRanges;
   this->_mCoreSize = coreSize;
-  this->_mNRange = 1;
-  this->_mNodeStart2 = -1;
-  this->_mNodeEnd2 = -1;
   this->_mDownNodes = 0;
   this->_mUpNodes = 0;
   this->_mIdleNodes = 0;
@@ -60,7 +53,25 @@ Queue::Queue(QString machineName, QString queueName, QString queueCore,
 }
 
 /**
- * @brief Queue::Queue Default constructor
+ * @brief Queue::Queue Constructor for a queue with one range of nodes
+ * @param machineName Name of machine
+ * @param queueName Name of queue
+ * @param queueCore Name of cores
+ * @param queueStart Start index for queue
+ * @param queueEnd End index for queue
+ * @param coreSize Number of processors on each core
+ * @param nameFormat Number of digits in each core
+ * @param parent Pointer to parent object
+ */
+Queue::Queue(QString machineName, QString queueName, QString queueCore,
+             int queueStart, int queueEnd, int coreSize, int nameFormat,
+             QObject *parent)
+    : Queue(machineName, queueName, queueCore,
+            QVector<QPair<int, int> >() << qMakePair(queueStart, queueEnd),
+            coreSize, nameFormat, parent) {}
+
+/**
+ * @brief Queue::Queue Constructor for a queue with two ranges of nodes
  * @param machineName Name of machine
  * @param queueName Name of queue
  * @param queueCore Name of cores
@@ -75,26 +86,10 @@ Queue::Queue(QString machineName, QString queueName, QString queueCore,
 Queue::Queue(QString machineName, QString queueName, QString queueCore,
              int queueStart, int queueEnd, int queueStart2, int queueEnd2,
              int coreSize, int nameFormat, QObject *parent)
-    : QObject(parent) {
-  this->_mMachineName = machineName;
-  this->_mQueueName = queueName;
-  this->_mNodeName = queueCore;
-  this->_mNodeStart = queueStart;
-  this->_mNodeEnd = queueEnd;
-  this->_mNodeStart2 = queueStart2;
-  this->_mNodeEnd2 = queueEnd2;
-  this->_mCoreSize = coreSize;
-  this->_mNRange = 2;
-  this->_mDownNodes = 0;
-  this->_mUpNodes = 0;
-  this->_mIdleNodes = 0;
-  this->_mRunningNodes = 0;
-  this->_mIdleCores = 0;
-  this->_mRunningCores = 0;
-  this->_mNameFormat = nameFormat;
-  this->_hash();
-  this->_calculateSize();
-}
+    : Queue(machineName, queueName, queueCore,
+            QVector<QPair<int, int> >() << qMakePair(queueStart, queueEnd)
+                                        << qMakePair(queueStart2, queueEnd2),
+            coreSize, nameFormat, parent) {}
 
 /**
  * @brief Queue::_hash Generates a unique hash for the queue for searching later
@@ -105,10 +100,17 @@ void Queue::_hash() {
   hash.addData(this->_mMachineName.toUtf8());
   hash.addData(this->_mQueueName.toUtf8());
   hash.addData(this->_mNodeName.toUtf8());
-  hash.addData(QString::number(this->_mNodeStart).toUtf8());
-  hash.addData(QString::number(this->_mNodeEnd).toUtf8());
-  hash.addData(QString::number(this->_mNodeStart2).toUtf8());
-  hash.addData(QString::number(this->_mNodeEnd2).toUtf8());
+  for (int i = 0; i < this->_mNodeRanges.size(); i++) {
+    hash.addData(QString::number(this->_mNodeRanges[i].first).toUtf8());
+    hash.addData(QString::number(this->_mNodeRanges[i].second).toUtf8());
+  }
+
+  //...Single range queues hash as they did when the second
+  //   range was stored as -1 to -1
+  if (this->_mNodeRanges.size() == 1) {
+    hash.addData(QString::number(-1).toUtf8());
+    hash.addData(QString::number(-1).toUtf8());
+  }
   hash.addData(QString::number(this->_mCoreSize).toUtf8());
   this->_mHash = hash.result().toHex();
 }
@@ -119,16 +121,27 @@ void Queue::_hash() {
  */
 int Queue::nameFormat() { return this->_mNameFormat; }
 
+/**
+ * @brief Queue::coreSize Returns the number of cores on each node
+ * @return number of cores per node
+ */
+int Queue::coreSize() { return this->_mCoreSize; }
+
 /**
  * @brief Queue::_calculateSize Calculates the number of processors in this
- * queue
+ * queue and the set of nodes it contains
  */
 void Queue::_calculateSize() {
-  this->_mNcore = (this->_mNodeEnd - this->_mNodeStart + 1) * this->_mCoreSize;
-  if (this->_mNRange == 2)
-    this->_mNcore =
-        this->_mNcore +
-        (this->_mNodeEnd2 - this->_mNodeStart2 + 1) * this->_mCoreSize;
+  this->_mNcore = 0;
+  this->_mNodeMask.clear();
+  for (int i = 0; i < this->_mNodeRanges.size(); i++) {
+    int start = this->_mNodeRanges[i].first;
+    int end = this->_mNodeRanges[i].second;
+    if (start < 0 || end < start)
+      continue;
+    this->_mNodeMask.insertRange(start, end);
+  }
+  this->_mNcore = this->_mNodeMask.size() * this->_mCoreSize;
   return;
 }
 
@@ -145,134 +158,91 @@ QString Queue::queueName() { return this->_mQueueName; }
 QString Queue::machine() { return this->_mMachineName; }
 
 /**
- * @brief Queue::hash Returns the hash for this queue
- * @return queue hash
+ * @brief Queue::nodeName Returns the name of the nodes in this queue without
+ * the node number
+ * @return name of the nodes
  */
-QByteArray Queue::hash() { return this->_mHash; }
+QString Queue::nodeName() { return this->_mNodeName; }
 
 /**
- * @brief Queue::isInQueue Checks if the job specified is in the named queue
- * @param job pointer to a job
- * @param queueName name of a queue
- * @return boolean value for if the job is in the named queue
+ * @brief Queue::nodeRanges Returns the ranges of node numbers in this queue
+ * @return list of first and last node numbers
  */
-bool Queue::isInQueue(Qjob *job, QString queueName) {
-
-  if (job->status() == Qjob::SGE_STATUS_RUNNING) {
-    if (job->core() == this->_mNodeName) {
-      for (int i = this->_mNodeStart; i <= this->_mNodeEnd; i++) {
-        if (job->containsCore(i))
-          return true;
-      }
-      if (this->_mNRange == 2) {
-        for (int i = this->_mNodeStart2; i <= this->_mNodeEnd2; i++) {
-          if (job->containsCore(i))
-            return true;
-        }
-      }
-    } else
-      return false;
-    return false;
-  } else {
-    if (this->_mQueueName == queueName)
-      return true;
-    else
-      return false;
-  }
+QVector<QPair<int, int> > Queue::nodeRanges() {
+  return this->_mNodeRanges;
 }
 
 /**
- * @brief Queue::isOnNodes Checks if the job pointer is on this queue
- * @param testJob pointer to job
- * @return boolean if the job is in this queue
+ * @brief Queue::nodeMask Returns the set of node numbers in this queue
+ * @return set of node numbers
  */
-bool Queue::isOnNodes(Qjob *testJob) {
-  if (testJob->core() == this->_mNodeName) {
-    if (this->_mNRange == 1) {
-      if (testJob->coreNumber() >= this->_mNodeStart &&
-          testJob->coreNumber() <= this->_mNodeEnd)
-        return true;
-      else
-        return false;
-    } else if (this->_mNRange == 2) {
-      if (testJob->coreNumber() >= this->_mNodeStart &&
-          testJob->coreNumber() <= this->_mNodeEnd)
-        return true;
-      else if (testJob->coreNumber() >= this->_mNodeStart2 &&
-               testJob->coreNumber() <= this->_mNodeEnd2)
-        return true;
-      else
-        return false;
-    } else
-      return false;
-  } else
-    return false;
-}
+const NodeSet &Queue::nodeMask() { return this->_mNodeMask; }
 
 /**
- * @brief Queue::getQueueHealth Gets the current health status of the queue
+ * @brief Queue::hash Returns the hash for this queue
+ * @return queue hash
  */
-void Queue::getQueueHealth() {
-  QString cmd = "qstat -f";
-  QEventLoop loop;
-  QProcess command(this);
-  QStringList splitString;
-  QString node, load, tempString;
-  int id, c1, c2, c3;
-  bool isProcessor;
-  bool ok;
-
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  env.insert("IFS", "");
-
-  command.start(cmd);
-  command.setEnvironment(env.toStringList());
-  connect(&command, SIGNAL(finished(int, QProcess::ExitStatus)), &loop,
-          SLOT(quit()));
-  loop.exec();
-
-  QStringList queueData = QString(command.readAllStandardOutput()).split("\n");
-  queueData = queueData.filter(this->_mNodeName);
+QByteArray Queue::hash() { return this->_mHash; }
 
+/**
+ * @brief Queue::resetHealth Clears the health counters before a new set of
+ * hosts is added
+ */
+void Queue::resetHealth() {
   this->_mDownNodes = 0;
   this->_mUpNodes = 0;
+  this->_mIdleNodes = 0;
+  this->_mRunningNodes = 0;
+  this->_mIdleCores = 0;
+  this->_mRunningCores = 0;
+  return;
+}
 
-  for (int i = 0; i < queueData.length(); i++) {
-    splitString = queueData.value(i).simplified().split(" ");
-
-    node = splitString.value(0);
-    load = splitString.value(2);
-    tempString = node.split(".").value(0);
-    id = tempString.right(this->nameFormat()).toInt(&ok);
-
-    isProcessor = false;
-    if (id >= this->_mNodeStart && id <= this->_mNodeEnd)
-      isProcessor = true;
-    else if (this->_mNRange == 2 && id >= this->_mNodeStart2 &&
-             id <= this->_mNodeEnd2)
-      isProcessor = true;
-
-    if (isProcessor) {
-      if (splitString.length() == 6)
-        this->_mDownNodes = this->_mDownNodes + 1;
-      else {
-        this->_mUpNodes = this->_mUpNodes + 1;
+/**
+ * @brief Queue::addNodeHealth Adds a node that belongs to this queue to the
+ * health counters
+ * @param isDown true if the node is not reporting
+ * @param usedCores number of slots in use on the node
+ */
+void Queue::addNodeHealth(bool isDown, int usedCores) {
+  this->_applyNodeHealth(isDown, usedCores, 1);
+  return;
+}
 
-        c1 = load.split("/").value(0).toInt();
-        c2 = load.split("/").value(1).toInt();
-        c3 = load.split("/").value(2).toInt();
+/**
+ * @brief Queue::removeNodeHealth Takes a node that was added with
+ * addNodeHealth() back out of the health counters
+ * @param isDown value of isDown the node was added with
+ * @param usedCores value of usedCores the node was added with
+ */
+void Queue::removeNodeHealth(bool isDown, int usedCores) {
+  this->_applyNodeHealth(isDown, usedCores, -1);
+  return;
+}
 
-        if (c2 > 0) {
-          this->_mRunningNodes = this->_mRunningNodes + 1;
-          this->_mRunningCores = this->_mRunningCores + c2;
-          this->_mIdleCores = this->_mIdleCores + (this->_mCoreSize - c2);
-        } else if (c2 == 0) {
-          this->_mIdleNodes = this->_mIdleNodes + 1;
-          this->_mIdleCores = this->_mIdleCores + this->_mCoreSize;
-        }
-      }
+/**
+ * @brief Queue::_applyNodeHealth Adds a node to or subtracts it from the
+ * health counters
+ * @param isDown true if the node is not reporting
+ * @param usedCores number of slots in use on the node
+ * @param sign 1 to add the node, -1 to subtract it
+ */
+void Queue::_applyNodeHealth(bool isDown, int usedCores, int sign) {
+  if (isDown)
+    this->_mDownNodes = this->_mDownNodes + sign;
+  else {
+    this->_mUpNodes = this->_mUpNodes + sign;
+    if (usedCores > 0) {
+      this->_mRunningNodes = this->_mRunningNodes + sign;
+      this->_mRunningCores = this->_mRunningCores + sign * usedCores;
+      this->_mIdleCores =
+          this->_mIdleCores + sign * (this->_mCoreSize - usedCores);
+    } else if (usedCores == 0) {
+      this->_mIdleNodes = this->_mIdleNodes + sign;
+      this->_mIdleCores = this->_mIdleCores + sign * this->_mCoreSize;
     }
   }
+  return;
 }
 
 /**
@@ -325,3 +295,37 @@ int Queue::queueFreeCores() { return this->_mIdleCores; }
  * @return number of running cores
  */
 int Queue::queueRunningCores() { return this->_mRunningCores; }
+
+/**
+ * @brief Queue::healthState Packs the health counters for this queue so they
+ * can be sent to another process
+ * @return packed health counters
+ */
+QByteArray Queue::healthState() {
+  QByteArray state;
+  QDataStream stream(&state, QIODevice::WriteOnly);
+  stream << qint32(this->_mDownNodes) << qint32(this->_mUpNodes)
+         << qint32(this->_mIdleNodes) << qint32(this->_mRunningNodes)
+         << qint32(this->_mRunningCores) << qint32(this->_mIdleCores);
+  return state;
+}
+
+/**
+ * @brief Queue::setHealthState Restores the health counters for this queue
+ * from the output of healthState()
+ * @param state packed health counters
+ */
+void Queue::setHealthState(QByteArray state) {
+  qint32 down, up, idle, runningNodes, runningCores, idleCores;
+  QDataStream stream(state);
+  stream >> down >> up >> idle >> runningNodes >> runningCores >> idleCores;
+  if (stream.status() != QDataStream::Ok)
+    return;
+  this->_mDownNodes = down;
+  this->_mUpNodes = up;
+  this->_mIdleNodes = idle;
+  this->_mRunningNodes = runningNodes;
+  this->_mRunningCores = runningCores;
+  this->_mIdleCores = idleCores;
+  return;
+}
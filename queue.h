@@ -22,13 +22,19 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
+#include "nodeset.h"
 #include "qjob.h"
 #include <QCryptographicHash>
 #include <QObject>
+#include <QPair>
+#include <QVector>
 
 class Queue : public QObject {
   Q_OBJECT
 public:
+  explicit Queue(QString machineName, QString queueName, QString queueCore,
+                 QVector<QPair<int, int> > nodeRanges, int coreSize,
+                 int nameFormat, QObject *parent = nullptr);
   explicit Queue(QString machineName, QString queueName, QString queueCore,
                  int queueStart, int queueEnd, int coreSize, int nameFormat,
                  QObject *parent = nullptr);
@@ -36,15 +42,17 @@ public:
                  int queueStart, int queueEnd, int queueStart2, int queueEnd2,
                  int coreSize, int nameFormat, QObject *parent = nullptr);
 
-  bool isInQueue(Qjob *job, QString queueName);
-  bool isOnNodes(Qjob *testJob);
-
   QByteArray hash();
 
   QString queueName();
   QString machine();
+  QString nodeName();
+  QVector<QPair<int, int> > nodeRanges();
+  const NodeSet &nodeMask();
 
-  void getQueueHealth();
+  void resetHealth();
+  void addNodeHealth(bool isDown, int usedCores);
+  void removeNodeHealth(bool isDown, int usedCores);
 
   int queueTotalNodes();
   int queueUpNodes();
@@ -55,8 +63,14 @@ public:
   int queueFreeCores();
   int queueRunningCores();
   int nameFormat();
+  int coreSize();
+
+  QByteArray healthState();
+  void setHealthState(QByteArray state);
 
 private:
+  void _applyNodeHealth(bool isDown, int usedCores, int sign);
+
   /// Name of the nodes
   QString _mNodeName;
 
@@ -66,24 +80,12 @@ private:
   /// Name of the machine
   QString _mMachineName;
 
-  /// Start index for nodes in this queue
-  int _mNodeStart;
-
-  /// End index for nodes in this queue
-  int _mNodeEnd;
-
-  /// Second start index for nodes in this queue
-  int _mNodeStart2;
-
-  /// Second end index for nodes in this queue
-  int _mNodeEnd2;
+  /// First and last node of each range of nodes in this queue
+  QVector<QPair<int, int> > _mNodeRanges;
 
   /// Size of the cores in this queue
   int _mCoreSize;
 
-  /// Number of ranges of cores (1 or 2)
-  int _mNRange;
-
   /// Number of cores in the queue
   int _mNcore;
 
@@ -105,9 +107,13 @@ private:
   /// Number of cores currently idle
   int _mIdleCores;
 
-  /// Number of digits used in the specification of node numbers
+  /// Number of digits used in the specification of node numbers, 0 if the
+  /// numbers are not padded
   int _mNameFormat;
 
+  /// Set of node numbers in this queue, compared against job node sets
+  NodeSet _mNodeMask;
+
   /// A unique hash for the queue
   QByteArray _mHash;
 
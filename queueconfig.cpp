@@ -0,0 +1,198 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: queueconfig.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "queueconfig.h"
+#include <QFile>
+#include <QMap>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTextStream>
+
+/**
+ * @brief QueueConfig::defaultFilename Returns the default location of the
+ * queue definitions, $XDG_CONFIG_HOME/qview/queues.conf
+ * @return path to the file
+ */
+QString QueueConfig::defaultFilename() {
+  return QStandardPaths::writableLocation(
+             QStandardPaths::GenericConfigLocation) +
+         "/qview/queues.conf";
+}
+
+/**
+ * @brief QueueConfig::read Reads queue definitions from a file. Each queue
+ * is a section, shown in the order it appears:
+ *
+ *   [aegaeon_984]
+ *   machine = Aegaeon
+ *   queue = @@westerink_d12chas_984
+ *   hosts = d12chas%03d
+ *   nodes = 20-40, 83-102
+ *   cores = 24
+ *
+ * hosts gives the node name followed by a printf style number, %03d for
+ * three zero padded digits or %d for numbers that are not padded. nodes is
+ * any list of node numbers and ranges, each below NodeSet::maxNodeNumber.
+ * Lines starting with # or ; are comments
+ * @param filename file to read
+ * @param queues filled with the queues, in file order
+ * @param parent parent of the new queues
+ * @return status code
+ */
+int QueueConfig::read(QString filename, QVector<Queue *> &queues,
+                      QObject *parent) {
+  QTextStream error(stderr);
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    error << "Unable to open " << filename << "\n";
+    return 1;
+  }
+
+  QStringList sections;
+  QMap<QString, QMap<QString, QString> > values;
+  QMap<QString, QMap<QString, int> > lines;
+  QString section;
+  int lineNumber = 0;
+
+  QTextStream input(&file);
+  while (!input.atEnd()) {
+    QString line = input.readLine().trimmed();
+    lineNumber++;
+    if (line.isEmpty() || line.startsWith("#") || line.startsWith(";"))
+      continue;
+
+    if (line.startsWith("[") && line.endsWith("]")) {
+      section = line.mid(1, line.length() - 2).trimmed();
+      if (section.isEmpty() || sections.contains(section)) {
+        error << filename << ":" << lineNumber
+              << ": empty or repeated section name\n";
+        return 1;
+      }
+      sections << section;
+      continue;
+    }
+
+    int equals = line.indexOf('=');
+    if (equals < 0 || section.isEmpty()) {
+      error << filename << ":" << lineNumber << ": expected key = value\n";
+      return 1;
+    }
+    QString key = line.left(equals).trimmed();
+    values[section][key] = line.mid(equals + 1).trimmed();
+    lines[section][key] = lineNumber;
+  }
+
+  QVector<Queue *> result;
+  for (int i = 0; i < sections.size(); i++) {
+    const QMap<QString, QString> &v = values[sections[i]];
+    QVector<QPair<int, int> > ranges;
+    QString nodeName;
+    int nameFormat;
+    bool ok;
+
+    int cores = v.value("cores").toInt(&ok);
+    QString problem, key;
+    if (v.value("queue").isEmpty()) {
+      problem = "missing queue";
+    } else if (!parseHostFormat(v.value("hosts"), nodeName, nameFormat)) {
+      problem = "hosts must be a name followed by %d or %0Nd";
+      key = "hosts";
+    } else if (!parseRanges(v.value("nodes"), ranges)) {
+      problem = QString("nodes must be a list of numbers and ranges such as "
+                        "1-10, each below %1")
+                    .arg(NodeSet::maxNodeNumber);
+      key = "nodes";
+    } else if (!ok || cores < 1) {
+      problem = "cores must be a positive number";
+      key = "cores";
+    }
+
+    if (!problem.isEmpty()) {
+      error << filename << ":";
+      if (lines[sections[i]].contains(key))
+        error << lines[sections[i]][key] << ":";
+      error << " [" << sections[i] << "]: " << problem << "\n";
+      qDeleteAll(result);
+      return 1;
+    }
+
+    result.push_back(new Queue(v.value("machine", sections[i]),
+                               v.value("queue"), nodeName, ranges, cores,
+                               nameFormat, parent));
+  }
+
+  queues = result;
+  return 0;
+}
+
+/**
+ * @brief QueueConfig::parseRanges Reads a list of node numbers and ranges
+ * such as "1-10, 12, 20-40". Node numbers must be below
+ * NodeSet::maxNodeNumber, since the queue index holds a table entry for
+ * every node up to the highest
+ * @param text list to read
+ * @param ranges filled with the first and last node of each range
+ * @return true if the list is valid
+ */
+bool QueueConfig::parseRanges(QString text,
+                              QVector<QPair<int, int> > &ranges) {
+  QStringList items = text.split(",", QString::SkipEmptyParts);
+  ranges.clear();
+  for (int i = 0; i < items.size(); i++) {
+    QStringList bounds = items[i].trimmed().split("-");
+    bool okStart, okEnd;
+    int start = bounds.value(0).trimmed().toInt(&okStart);
+    int end = bounds.value(bounds.size() - 1).trimmed().toInt(&okEnd);
+    if (bounds.size() > 2 || !okStart || !okEnd || start < 0 || end < start ||
+        end >= NodeSet::maxNodeNumber)
+      return false;
+    ranges.push_back(qMakePair(start, end));
+  }
+  return !ranges.isEmpty();
+}
+
+/**
+ * @brief QueueConfig::parseHostFormat Reads a host name format such as
+ * d12chas%03d
+ * @param text format to read
+ * @param nodeName set to the text before the number
+ * @param nameFormat set to the number of digits, 0 if not padded
+ * @return true if the format is valid
+ */
+bool QueueConfig::parseHostFormat(QString text, QString &nodeName,
+                                  int &nameFormat) {
+  int percent = text.indexOf('%');
+  if (percent < 1 || !text.endsWith("d"))
+    return false;
+
+  QString width = text.mid(percent + 1, text.length() - percent - 2);
+  if (width.isEmpty()) {
+    nameFormat = 0;
+  } else {
+    bool ok;
+    nameFormat = width.toInt(&ok);
+    if (!ok || nameFormat < 1)
+      return false;
+  }
+
+  nodeName = text.left(percent);
+  return true;
+}
@@ -0,0 +1,44 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: queueconfig.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef QUEUECONFIG_H
+#define QUEUECONFIG_H
+
+#include "queue.h"
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class QueueConfig {
+public:
+  static QString defaultFilename();
+
+  static int read(QString filename, QVector<Queue *> &queues,
+                  QObject *parent = nullptr);
+
+  static bool parseRanges(QString text, QVector<QPair<int, int> > &ranges);
+
+  static bool parseHostFormat(QString text, QString &nodeName,
+                              int &nameFormat);
+};
+
+#endif // QUEUECONFIG_H
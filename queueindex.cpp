@@ -0,0 +1,233 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: queueindex.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "queueindex.h"
+#include <QStringList>
+
+/**
+ * @brief QueueIndex::QueueIndex Default constructor
+ * @param parent Pointer to parent object
+ */
+QueueIndex::QueueIndex(QObject *parent) : QObject(parent) {}
+
+/**
+ * @brief QueueIndex::build Compiles the queue definitions into flat tables
+ * from node name, node number format and node number to the queues that
+ * own the node
+ * @param queues list of queues to index
+ */
+void QueueIndex::build(const QVector<Queue *> &queues) {
+  this->_mNodeTables.clear();
+  this->_mNameTable.clear();
+
+  for (int i = 0; i < queues.size(); i++) {
+    Queue *q = queues[i];
+
+    //...Queues on the same hosts may number them differently, so
+    //   each format gets a table of its own
+    QVector<NodeTable> &tables = this->_mNodeTables[q->nodeName()];
+    int t = 0;
+    while (t < tables.size() && tables[t].nameFormat != q->nameFormat())
+      t++;
+    if (t == tables.size()) {
+      tables.push_back(NodeTable());
+      tables[t].nameFormat = q->nameFormat();
+    }
+    NodeTable &table = tables[t];
+    if (!table.owners.contains(q))
+      table.owners.push_back(q);
+
+    QVector<QPair<int, int> > ranges = q->nodeRanges();
+    for (int j = 0; j < ranges.size(); j++) {
+      if (ranges[j].first < 0 || ranges[j].second < ranges[j].first ||
+          ranges[j].second >= NodeSet::maxNodeNumber)
+        continue;
+      if (table.queues.size() <= ranges[j].second)
+        table.queues.resize(ranges[j].second + 1);
+      for (int n = ranges[j].first; n <= ranges[j].second; n++)
+        if (!table.queues[n].contains(q))
+          table.queues[n].push_back(q);
+    }
+
+    this->_mNameTable[q->queueName()].push_back(q);
+  }
+  return;
+}
+
+/**
+ * @brief QueueIndex::_findTable Finds the table of the queues a host name
+ * from the scheduler output belongs to. Node names may end in digits
+ * themselves, so each split of the trailing digits is tried against the
+ * configured names. A split only matches a queue that writes its node
+ * numbers with that many digits, or that does not pad them and uses every
+ * trailing digit without a leading zero
+ * @param host host name, optionally prefixed with queue@ and followed by
+ * the domain
+ * @param node set to the node number
+ * @return table of the matching queues, or nullptr if there is none
+ */
+const QueueIndex::NodeTable *QueueIndex::_findTable(const QString &host,
+                                                    int &node) const {
+  int start = host.indexOf('@') + 1;
+  int end = host.indexOf('.', start);
+  if (end < 0)
+    end = host.length();
+
+  int digits = end;
+  while (digits > start && host.at(digits - 1).isDigit())
+    digits--;
+  if (digits == end)
+    return nullptr;
+
+  for (int width = end - digits; width > 0; width--) {
+    QHash<QString, QVector<NodeTable> >::const_iterator it =
+        this->_mNodeTables.constFind(host.mid(start, end - width - start));
+    if (it == this->_mNodeTables.constEnd())
+      continue;
+    const QVector<NodeTable> &tables = it.value();
+    for (int t = 0; t < tables.size(); t++) {
+      int format = tables[t].nameFormat;
+      if (format > 0 && width != format)
+        continue;
+      if (format <= 0 && (width != end - digits ||
+                          (width > 1 && host.at(end - width) == '0')))
+        continue;
+      node = host.midRef(end - width, width).toInt();
+      return &tables[t];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief QueueIndex::splitHost Splits a host name from the scheduler output
+ * into the node name and node number of the queues. The job listing, the
+ * job details and the host status all split hosts here, so they agree on
+ * the node a host is
+ * @param host host name, optionally prefixed with queue@ and followed by
+ * the domain
+ * @param nodeName set to the name of the node without its number
+ * @param node set to the node number
+ * @return true if the host matches a configured node name
+ */
+bool QueueIndex::splitHost(const QString &host, QString &nodeName,
+                           int &node) const {
+  int number;
+  const NodeTable *table = this->_findTable(host, number);
+  if (table == nullptr)
+    return false;
+  nodeName = table->owners.first()->nodeName();
+  node = number;
+  return true;
+}
+
+/**
+ * @brief QueueIndex::queuesOnHost Returns the queues that own a host from
+ * the scheduler output
+ * @param host host name, optionally prefixed with queue@ and followed by
+ * the domain
+ * @return list of queues that own the host
+ */
+const QVector<Queue *> &QueueIndex::queuesOnHost(const QString &host) {
+  int node;
+  const NodeTable *table = this->_findTable(host, node);
+  if (table == nullptr || node < 0 || node >= table->queues.size())
+    return this->_mEmpty;
+  return table->queues[node];
+}
+
+/**
+ * @brief QueueIndex::queuesByName Returns the queues with a scheduler queue
+ * name
+ * @param queueName name of the queue
+ * @return list of queues with the name
+ */
+const QVector<Queue *> &QueueIndex::queuesByName(const QString &queueName) {
+  QHash<QString, QVector<Queue *> >::const_iterator it =
+      this->_mNameTable.constFind(queueName);
+  if (it == this->_mNameTable.constEnd())
+    return this->_mEmpty;
+  return it.value();
+}
+
+/**
+ * @brief QueueIndex::queuesRequested Returns the queues named in a queue
+ * request, which lists one or more scheduler queue names separated by
+ * commas
+ * @param request queue request of a job, as kept by Qjob::queueName
+ * @return list of queues named in the request
+ */
+QVector<Queue *> QueueIndex::queuesRequested(const QString &request) {
+  if (!request.contains(','))
+    return this->queuesByName(request);
+
+  QVector<Queue *> queues;
+  QStringList names = request.split(',', QString::SkipEmptyParts);
+  for (int i = 0; i < names.size(); i++) {
+    const QVector<Queue *> &q = this->queuesByName(names[i]);
+    for (int j = 0; j < q.size(); j++)
+      if (!queues.contains(q[j]))
+        queues.push_back(q[j]);
+  }
+  return queues;
+}
+
+/**
+ * @brief QueueIndex::queuesForJob Returns every queue a job uses resources
+ * from. Running jobs are placed by their nodes and other jobs by the queue
+ * they requested. The node set of a running job is compared against the
+ * node mask of each queue with the same node name and number format, so
+ * the cost does not depend on the number of nodes the job uses
+ * @param job pointer to a job
+ * @return list of queues
+ */
+QVector<Queue *> QueueIndex::queuesForJob(Qjob *job) {
+  if (job->status() != Qjob::SGE_STATUS_RUNNING)
+    return this->queuesRequested(job->queueName());
+
+  int node;
+  const NodeTable *table = this->_findTable(job->node(), node);
+  if (table == nullptr)
+    return QVector<Queue *>();
+
+  //...Without its details only the main node of a job is known
+  const NodeSet &nodes = job->nodeSet();
+  bool mainNodeOnly = nodes.isEmpty() && !job->hasDetails();
+
+  QVector<Queue *> queues;
+  const QVector<Queue *> &owners = table->owners;
+  for (int i = 0; i < owners.size(); i++) {
+    const NodeSet &mask = owners[i]->nodeMask();
+    if (mainNodeOnly ? mask.contains(node) : mask.intersects(nodes))
+      queues.push_back(owners[i]);
+  }
+  return queues;
+}
+
+/**
+ * @brief QueueIndex::isOnNodes Checks if the main node of a job belongs to
+ * any queue
+ * @param job pointer to a job
+ * @return true if the job's node is in any queue
+ */
+bool QueueIndex::isOnNodes(Qjob *job) {
+  return !this->queuesOnHost(job->node()).isEmpty();
+}
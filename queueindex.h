@@ -0,0 +1,74 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: queueindex.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef QUEUEINDEX_H
+#define QUEUEINDEX_H
+
+#include "qjob.h"
+#include "queue.h"
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+class QueueIndex : public QObject {
+  Q_OBJECT
+public:
+  explicit QueueIndex(QObject *parent = nullptr);
+
+  void build(const QVector<Queue *> &queues);
+
+  bool splitHost(const QString &host, QString &nodeName, int &node) const;
+
+  const QVector<Queue *> &queuesOnHost(const QString &host);
+
+  const QVector<Queue *> &queuesByName(const QString &queueName);
+
+  QVector<Queue *> queuesRequested(const QString &request);
+
+  QVector<Queue *> queuesForJob(Qjob *job);
+
+  bool isOnNodes(Qjob *job);
+
+private:
+  /// Lookup table for the queues that share a node name and a node number
+  /// format, indexed by node number
+  struct NodeTable {
+    int nameFormat;
+    QVector<QVector<Queue *> > queues;
+
+    /// Every queue in this table, whose node masks are compared against
+    /// the nodes of a job
+    QVector<Queue *> owners;
+  };
+
+  const NodeTable *_findTable(const QString &host, int &node) const;
+
+  /// Tables for each node name, one for each node number format used
+  QHash<QString, QVector<NodeTable> > _mNodeTables;
+
+  /// Queues for each scheduler queue name
+  QHash<QString, QVector<Queue *> > _mNameTable;
+
+  /// Returned when a lookup finds nothing
+  QVector<Queue *> _mEmpty;
+};
+
+#endif // QUEUEINDEX_H
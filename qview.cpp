@@ -19,11 +19,113 @@
 //
 //------------------------------------------------------------------------------
 
+#include "historylog.h"
+#include "profilingbackend.h"
+#include "queueconfig.h"
+#include "qviewdaemon.h"
+#include "recordingbackend.h"
+#include "replaybackend.h"
+#include "sgebackend.h"
 #include "viewqueue.h"
+#include <QTextStream>
 #include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QFile>
 #include <QTimer>
 
+/**
+ * @brief profileReport Writes the profile of a run to stderr and the trace
+ * file if one was asked for
+ * @param profiler profiler holding the run
+ * @param traceFile file to write the trace to, empty for none
+ * @param status exit code of the run
+ * @return exit code
+ */
+static int profileReport(Profiler *profiler, QString traceFile, int status) {
+  QTextStream stream(stderr);
+  stream << "\n";
+  profiler->report(stream);
+  if (!traceFile.isEmpty() && profiler->writeTrace(traceFile) != 0)
+    return 1;
+  return status;
+}
+
+/**
+ * @brief showHistory Prints the average state of each queue over each
+ * interval of a range of the history log
+ * @param history log to read
+ * @param qstat queue definitions used to name the queues
+ * @param from start of the range
+ * @param to end of the range
+ * @param interval length of each interval in seconds
+ * @param queueName queue to show, empty for all
+ * @return exit code
+ */
+static int showHistory(HistoryLog *history, Qstat *qstat, QDateTime from,
+                       QDateTime to, int interval, QString queueName) {
+  QVector<HistoryLog::Usage> usage;
+  QMap<QByteArray, Queue *> queues;
+  QByteArray selected;
+
+  for (int i = 0; i < qstat->numQueues(); i++)
+    queues[qstat->queue(i)->hash()] = qstat->queue(i);
+
+  if (!queueName.isEmpty()) {
+    Queue *queue = qstat->queue(queueName);
+    if (queue == nullptr) {
+      QTextStream(stderr) << "Unknown queue: " << queueName << "\n";
+      return 1;
+    }
+    selected = queue->hash();
+  }
+
+  if (history->query(from, to, interval, usage) != 0)
+    return 1;
+
+  QTextStream output(stdout);
+  output << QString("%1  %2%3%4%5%6%7%8%9%10%11\n")
+                .arg("Time", -16)
+                .arg("Queue", -36)
+                .arg("Samples", 8)
+                .arg("Used", 8)
+                .arg("Cores", 8)
+                .arg("Util %", 8)
+                .arg("Up", 7)
+                .arg("Down", 7)
+                .arg("Idle", 7)
+                .arg("Running", 9)
+                .arg("Pending", 9);
+
+  for (int i = 0; i < usage.size(); i++) {
+    const HistoryLog::Usage &u = usage[i];
+    if (!selected.isEmpty() && u.hash != selected)
+      continue;
+
+    //...Queues no longer defined are shown by their hash
+    QString name = "? " + QString(u.hash.left(8));
+    if (queues.contains(u.hash))
+      name = queues[u.hash]->machine() + " " + queues[u.hash]->queueName();
+
+    double utilization =
+        u.totalCores > 0 ? 100.0 * u.runningCores / u.totalCores : 0.0;
+
+    output << QString("%1  %2%3%4%5%6%7%8%9%10%11\n")
+                  .arg(u.start.toLocalTime().toString("yyyy-MM-dd hh:mm"),
+                       -16)
+                  .arg(name, -36)
+                  .arg(u.samples, 8)
+                  .arg(u.runningCores, 8, 'f', 1)
+                  .arg(u.totalCores, 8, 'f', 0)
+                  .arg(utilization, 8, 'f', 1)
+                  .arg(u.upNodes, 7, 'f', 1)
+                  .arg(u.downNodes, 7, 'f', 1)
+                  .arg(u.idleNodes, 7, 'f', 1)
+                  .arg(u.runningJobs, 9, 'f', 1)
+                  .arg(u.pendingJobs, 9, 'f', 1);
+  }
+  return 0;
+}
+
 /**
  * @brief main main entry point for the code
  * @return exit code
@@ -41,9 +143,237 @@ int main(int argc, char *argv[]) {
   parser.addHelpOption();
   parser.addVersionOption();
 
+  QCommandLineOption parallelOption(
+      "parallel", "Maximum number of qstat processes to run at once",
+      "count", "4");
+  parser.addOption(parallelOption);
+
+  QCommandLineOption timeoutOption(
+      "timeout",
+      "Kill a qstat call that takes longer than <seconds>, 0 for no limit",
+      "seconds", "60");
+  parser.addOption(timeoutOption);
+
+  QCommandLineOption deadlineOption(
+      "deadline",
+      "Show whatever has arrived after <seconds>, 0 for no limit", "seconds",
+      "0");
+  parser.addOption(deadlineOption);
+
+  QCommandLineOption noCacheOption(
+      "no-cache", "Do not use the on-disk cache of job details");
+  parser.addOption(noCacheOption);
+
+  QCommandLineOption watchOption(
+      "watch", "Refresh the display every <seconds> until interrupted",
+      "seconds", "0");
+  parser.addOption(watchOption);
+
+  QCommandLineOption allOption("all", "Show every queue without asking");
+  parser.addOption(allOption);
+
+  QCommandLineOption queueOption("queue", "Show the named queue without asking",
+                                 "name");
+  parser.addOption(queueOption);
+
+  QCommandLineOption daemonOption(
+      "daemon", "Collect on a schedule and serve snapshots to other clients");
+  parser.addOption(daemonOption);
+
+  QCommandLineOption intervalOption(
+      "interval", "Seconds between collections in daemon mode", "seconds",
+      "30");
+  parser.addOption(intervalOption);
+
+  QCommandLineOption socketOption(
+      "socket", "Socket used to reach the collector daemon", "path",
+      QviewDaemon::defaultSocketName());
+  parser.addOption(socketOption);
+
+  QCommandLineOption sharedSocketOption(
+      "shared-socket", "Let every user on the machine read from the daemon");
+  parser.addOption(sharedSocketOption);
+
+  QCommandLineOption noDaemonOption(
+      "no-daemon", "Always query the scheduler directly");
+  parser.addOption(noDaemonOption);
+
+  QCommandLineOption configOption(
+      "config", "Read the queue definitions from <file>", "file");
+  parser.addOption(configOption);
+
+  QCommandLineOption formatOption(
+      "format", "Output format: table, json, ndjson or csv", "format",
+      "table");
+  parser.addOption(formatOption);
+
+  QCommandLineOption recordOption(
+      "record", "Save the raw scheduler output to <directory>", "directory");
+  parser.addOption(recordOption);
+
+  QCommandLineOption replayOption(
+      "replay", "Read the scheduler output saved by --record from <directory>",
+      "directory");
+  parser.addOption(replayOption);
+
+  QCommandLineOption latencyOption(
+      "latency", "Delay added to every replayed scheduler call", "msec", "0");
+  parser.addOption(latencyOption);
+
+  QCommandLineOption profileOption(
+      "profile",
+      "Report the time spent in each phase, every scheduler call and the "
+      "peak memory use on exit");
+  parser.addOption(profileOption);
+
+  QCommandLineOption traceOption(
+      "trace", "Write a Chrome trace event file of the run to <file>. "
+               "Implies --profile",
+      "file");
+  parser.addOption(traceOption);
+
+  QCommandLineOption historyOption(
+      "history", "Append each collected snapshot to the history log");
+  parser.addOption(historyOption);
+
+  QCommandLineOption historyDirOption(
+      "history-dir", "Directory holding the history log", "directory",
+      HistoryLog::defaultDirectory());
+  parser.addOption(historyDirOption);
+
+  QCommandLineOption fromOption(
+      "from", "Start of the range shown by history, default a week ago",
+      "date");
+  parser.addOption(fromOption);
+
+  QCommandLineOption toOption(
+      "to", "End of the range shown by history, default now", "date");
+  parser.addOption(toOption);
+
+  QCommandLineOption bucketOption(
+      "bucket", "Length of each interval shown by history", "minutes", "60");
+  parser.addOption(bucketOption);
+
+  parser.addPositionalArgument(
+      "command", "history to show the queue usage in the history log",
+      "[history]");
+
+  parser.process(a);
+
+  //...A replay never touches the job cache or a running daemon
+  //   since neither describes the recorded cluster
+  SchedulerBackend *backend = nullptr;
+  bool replay = parser.isSet(replayOption);
+  if (replay) {
+    ReplayBackend *replayBackend = new ReplayBackend(&a);
+    if (replayBackend->load(parser.value(replayOption)) != 0) {
+      QTextStream(stderr) << "Unable to read a recording from "
+                          << parser.value(replayOption) << "\n";
+      return 1;
+    }
+    replayBackend->setLatency(parser.value(latencyOption).toInt());
+    backend = replayBackend;
+  }
+  if (parser.isSet(recordOption)) {
+    if (backend == nullptr)
+      backend = new SgeBackend(&a);
+    backend = new RecordingBackend(backend, parser.value(recordOption), &a);
+  }
+
+  //...Profiling times every call made through the backend
+  Profiler *profiler = nullptr;
+  if (parser.isSet(profileOption) || parser.isSet(traceOption)) {
+    profiler = new Profiler(&a);
+    if (backend == nullptr)
+      backend = new SgeBackend(&a);
+    backend = new ProfilingBackend(backend, profiler, &a);
+  }
+
+  //...Queue definitions come from --config, else the default file
+  //   if there is one, else the built in queues
+  QString config = parser.value(configOption);
+  if (config.isEmpty() && QFile::exists(QueueConfig::defaultFilename()))
+    config = QueueConfig::defaultFilename();
+
+  HistoryLog *history = new HistoryLog(parser.value(historyDirOption), &a);
+
+  if (parser.positionalArguments().value(0) == "history") {
+    Qstat *qstat = new Qstat(&a);
+    if (!config.isEmpty() && qstat->loadQueues(config) != 0)
+      return 1;
+    QDateTime to = QDateTime::currentDateTime();
+    QDateTime from = to.addDays(-7);
+    if (parser.isSet(toOption))
+      to = QDateTime::fromString(parser.value(toOption), Qt::ISODate);
+    if (parser.isSet(fromOption))
+      from = QDateTime::fromString(parser.value(fromOption), Qt::ISODate);
+    if (!from.isValid() || !to.isValid()) {
+      QTextStream(stderr) << "Dates must be given as yyyy-MM-dd or "
+                             "yyyy-MM-ddThh:mm:ss\n";
+      return 1;
+    }
+    return showHistory(history, qstat, from, to,
+                       60 * parser.value(bucketOption).toInt(),
+                       parser.value(queueOption));
+  } else if (!parser.positionalArguments().isEmpty()) {
+    QTextStream(stderr) << "Unknown command: "
+                        << parser.positionalArguments().value(0) << "\n";
+    return 1;
+  }
+
+  if (!parser.isSet(historyOption))
+    history = nullptr;
+
+  if (parser.isSet(daemonOption)) {
+    QviewDaemon *daemon = new QviewDaemon(&a);
+    if (!config.isEmpty() && daemon->qstat()->loadQueues(config) != 0)
+      return 1;
+    if (backend != nullptr)
+      daemon->qstat()->setBackend(backend);
+    daemon->qstat()->setMaxProcesses(parser.value(parallelOption).toInt());
+    daemon->qstat()->setTimeout(1000 * parser.value(timeoutOption).toInt());
+    daemon->qstat()->setDeadline(1000 * parser.value(deadlineOption).toInt());
+    daemon->qstat()->setUseCache(!replay && !parser.isSet(noCacheOption));
+    daemon->qstat()->setProfiler(profiler);
+    daemon->qstat()->setHistory(history);
+    daemon->setSharedSocket(parser.isSet(sharedSocketOption));
+    if (daemon->start(parser.value(socketOption),
+                      parser.value(intervalOption).toInt()) != 0)
+      return 1;
+    int status = a.exec();
+    if (profiler != nullptr)
+      return profileReport(profiler, parser.value(traceOption), status);
+    return status;
+  }
+
   ViewQueue *queue = new ViewQueue(&a);
+  if (!config.isEmpty() && queue->loadQueues(config) != 0)
+    return 1;
+  if (backend != nullptr)
+    queue->setBackend(backend);
+  queue->setMaxProcesses(parser.value(parallelOption).toInt());
+  queue->setTimeout(1000 * parser.value(timeoutOption).toInt());
+  queue->setDeadline(1000 * parser.value(deadlineOption).toInt());
+  queue->setUseCache(!replay && !parser.isSet(noCacheOption));
+  queue->setProfiler(profiler);
+  queue->setHistory(history);
+  queue->setWatchInterval(parser.value(watchOption).toInt());
+  queue->setShowAll(parser.isSet(allOption));
+  queue->setQueueName(parser.value(queueOption));
+  if (queue->setFormat(parser.value(formatOption)) != 0) {
+    QTextStream(stderr) << "Unknown format: " << parser.value(formatOption)
+                        << "\n";
+    return 1;
+  }
+  //...A profiled or logged run must query the scheduler itself
+  if (!replay && profiler == nullptr && history == nullptr &&
+      !parser.isSet(noDaemonOption))
+    queue->setSocketName(parser.value(socketOption));
 
   QObject::connect(queue, SIGNAL(finished()), &a, SLOT(quit()));
   QTimer::singleShot(0, queue, SLOT(run()));
-  return a.exec();
+  int status = a.exec();
+  if (profiler != nullptr)
+    return profileReport(profiler, parser.value(traceOption), status);
+  return status;
 }
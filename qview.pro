@@ -20,6 +20,7 @@
 #------------------------------------------------------------------------------
 
 QT -= gui
+QT += network
 
 CONFIG += c++11 console
 CONFIG -= app_bundle
@@ -29,10 +30,46 @@ SOURCES += qview.cpp \
     viewqueue.cpp \
     qstat.cpp \
     queue.cpp \
-    qjob.cpp
+    qjob.cpp \
+    commandpool.cpp \
+    jobcache.cpp \
+    qviewdaemon.cpp \
+    queueindex.cpp \
+    nodeset.cpp \
+    jobdetailparser.cpp \
+    schedulerbackend.cpp \
+    sgebackend.cpp \
+    recordingbackend.cpp \
+    replaybackend.cpp \
+    tablerenderer.cpp \
+    jobexporter.cpp \
+    queueconfig.cpp \
+    profiler.cpp \
+    profilingbackend.cpp \
+    historylog.cpp \
+    hoststatusparser.cpp \
+    hosttable.cpp
 
 HEADERS += \
     viewqueue.h \
     qstat.h \
     queue.h \
-    qjob.h
+    qjob.h \
+    commandpool.h \
+    jobcache.h \
+    qviewdaemon.h \
+    queueindex.h \
+    nodeset.h \
+    jobdetailparser.h \
+    schedulerbackend.h \
+    sgebackend.h \
+    recordingbackend.h \
+    replaybackend.h \
+    tablerenderer.h \
+    jobexporter.h \
+    queueconfig.h \
+    profiler.h \
+    profilingbackend.h \
+    historylog.h \
+    hoststatusparser.h \
+    hosttable.h
@@ -0,0 +1,193 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: qviewdaemon.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "qviewdaemon.h"
+#include <QDataStream>
+#include <QDir>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <unistd.h>
+
+/**
+ * @brief QviewDaemon::QviewDaemon Default constructor
+ * @param parent Pointer to parent object
+ */
+QviewDaemon::QviewDaemon(QObject *parent) : QObject(parent) {
+  this->_mQueueStat = new Qstat(this);
+  this->_mServer = new QLocalServer(this);
+  this->_mTimer = new QTimer(this);
+  this->_mTimer->setSingleShot(true);
+  this->_mSharedSocket = false;
+  connect(this->_mTimer, SIGNAL(timeout()), this, SLOT(_refresh()));
+  connect(this->_mServer, SIGNAL(newConnection()), this,
+          SLOT(_newConnection()));
+}
+
+/**
+ * @brief QviewDaemon::defaultSocketName Returns the socket used when no
+ * socket is given. It lives in the runtime directory of the user, so no
+ * other user can take the name first and serve their own snapshots
+ * @return path to the socket
+ */
+QString QviewDaemon::defaultSocketName() {
+  QString directory =
+      QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+  if (directory.isEmpty())
+    return QDir::tempPath() + QString("/qview-%1.sock").arg(getuid());
+  return directory + "/qview.sock";
+}
+
+/**
+ * @brief QviewDaemon::setSharedSocket Lets every user of the machine
+ * connect to the socket. The socket should then be given a path in a
+ * directory only the user running the daemon can write to
+ * @param shared true to let every user connect
+ */
+void QviewDaemon::setSharedSocket(bool shared) {
+  this->_mSharedSocket = shared;
+  return;
+}
+
+/**
+ * @brief QviewDaemon::qstat Returns the object used for collection
+ * @return pointer to the qstat object
+ */
+Qstat *QviewDaemon::qstat() { return this->_mQueueStat; }
+
+/**
+ * @brief QviewDaemon::start Collects the first snapshot and begins serving
+ * clients
+ * @param socketName path of the socket to listen on
+ * @param interval seconds between collections
+ * @return status code
+ */
+int QviewDaemon::start(QString socketName, int interval) {
+  QTextStream output(stderr);
+
+  //...Refuse to replace a daemon that is still answering
+  QLocalSocket probe;
+  probe.connectToServer(socketName);
+  if (probe.waitForConnected(500)) {
+    output << "A qview daemon is already running on " << socketName << "\n";
+    return 1;
+  }
+
+  //...Anything left behind is from a daemon that did not exit cleanly
+  QLocalServer::removeServer(socketName);
+
+  this->_mTimer->setInterval((interval < 1 ? 1 : interval) * 1000);
+  this->_refresh();
+
+  if (this->_mSharedSocket)
+    this->_mServer->setSocketOptions(QLocalServer::WorldAccessOption);
+  else
+    this->_mServer->setSocketOptions(QLocalServer::UserAccessOption);
+  if (!this->_mServer->listen(socketName)) {
+    output << "Could not listen on " << socketName << ": "
+           << this->_mServer->errorString() << "\n";
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief QviewDaemon::_refresh Collects a new snapshot and replaces the one
+ * served to clients. Clients that connect while the scheduler is being
+ * queried are given the previous snapshot
+ */
+void QviewDaemon::_refresh() {
+  QByteArray payload, message;
+
+  this->_mQueueStat->collect();
+
+  QDataStream stream(&payload, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_5_0);
+  this->_mQueueStat->writeSnapshot(stream);
+
+  QDataStream messageStream(&message, QIODevice::WriteOnly);
+  messageStream.setVersion(QDataStream::Qt_5_0);
+  messageStream << payload;
+
+  this->_mSnapshot = message;
+
+  //...Schedule after the collection completes so slow runs never overlap
+  this->_mTimer->start();
+  return;
+}
+
+/**
+ * @brief QviewDaemon::_newConnection Sends the current snapshot to each new
+ * client and closes the connection
+ */
+void QviewDaemon::_newConnection() {
+  while (this->_mServer->hasPendingConnections()) {
+    QLocalSocket *socket = this->_mServer->nextPendingConnection();
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    socket->write(this->_mSnapshot);
+    socket->disconnectFromServer();
+  }
+  return;
+}
+
+/**
+ * @brief QviewDaemon::fetchSnapshot Reads the current snapshot from a running
+ * daemon into a qstat object. A daemon that reads other queue definitions
+ * is warned about and its snapshot is left unread
+ * @param socketName path of the daemon socket
+ * @param qstat object that receives the snapshot
+ * @return true if a complete snapshot was read
+ */
+bool QviewDaemon::fetchSnapshot(QString socketName, Qstat *qstat) {
+  QLocalSocket socket;
+  QByteArray data, payload;
+
+  socket.connectToServer(socketName, QIODevice::ReadOnly);
+  if (!socket.waitForConnected(500))
+    return false;
+
+  //...The daemon closes the connection once the snapshot is sent.
+  //   A peer that keeps writing past any real snapshot is dropped
+  while (socket.waitForReadyRead(5000)) {
+    data.append(socket.readAll());
+    if (data.size() > _maxSnapshotSize)
+      return false;
+  }
+  data.append(socket.readAll());
+  if (data.size() > _maxSnapshotSize)
+    return false;
+
+  QDataStream messageStream(data);
+  messageStream.setVersion(QDataStream::Qt_5_0);
+  messageStream >> payload;
+  if (messageStream.status() != QDataStream::Ok || payload.isEmpty())
+    return false;
+
+  QDataStream stream(payload);
+  stream.setVersion(QDataStream::Qt_5_0);
+  int ierr = qstat->readSnapshot(stream);
+  if (ierr == 2)
+    QTextStream(stderr) << "Warning: the qview daemon on " << socketName
+                        << " uses other queue definitions, querying the "
+                           "scheduler directly\n";
+  return ierr == 0;
+}
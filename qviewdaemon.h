@@ -0,0 +1,74 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: qviewdaemon.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef QVIEWDAEMON_H
+#define QVIEWDAEMON_H
+
+#include "qstat.h"
+#include <QByteArray>
+#include <QLocalServer>
+#include <QObject>
+#include <QTimer>
+
+class QviewDaemon : public QObject {
+  Q_OBJECT
+public:
+  explicit QviewDaemon(QObject *parent = nullptr);
+
+  static QString defaultSocketName();
+
+  void setSharedSocket(bool shared);
+
+  static bool fetchSnapshot(QString socketName, Qstat *qstat);
+
+  int start(QString socketName, int interval);
+
+  Qstat *qstat();
+
+signals:
+  void daemonError();
+
+private slots:
+  void _refresh();
+  void _newConnection();
+
+private:
+  /// Largest snapshot in bytes a client accepts from the socket
+  static const int _maxSnapshotSize = 256 * 1024 * 1024;
+
+  /// Object used to collect data from the scheduler
+  Qstat *_mQueueStat;
+
+  /// Server accepting client connections
+  QLocalServer *_mServer;
+
+  /// Timer used to schedule collection
+  QTimer *_mTimer;
+
+  /// True if every user of the machine may connect to the socket
+  bool _mSharedSocket;
+
+  /// Last complete snapshot sent to every client. The snapshot is only
+  /// replaced as a whole once a collection has finished
+  QByteArray _mSnapshot;
+};
+
+#endif // QVIEWDAEMON_H
@@ -0,0 +1,218 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: recordingbackend.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "recordingbackend.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QTextStream>
+
+/**
+ * @brief RecordingBackend::RecordingBackend Constructor. Every call is passed
+ * to another backend and its raw output is written to a directory that can
+ * later be read by ReplayBackend. The listings are overwritten on each
+ * refresh, while job detail documents accumulate
+ * @param backend backend to record, ownership is taken
+ * @param directory directory to write to
+ * @param parent Pointer to parent object
+ */
+RecordingBackend::RecordingBackend(SchedulerBackend *backend,
+                                   QString directory, QObject *parent)
+    : SchedulerBackend(parent) {
+  this->_mBackend = backend;
+  this->_mBackend->setParent(this);
+  this->_mDirectory = directory;
+  this->_mDetailsCount = 0;
+  connect(this->_mBackend, SIGNAL(idle()), this, SIGNAL(idle()));
+
+  //...Start from an empty index so old documents are not replayed
+  QDir().mkpath(directory);
+  QFile::remove(detailsIndexFile(directory));
+}
+
+/**
+ * @brief RecordingBackend::jobsFile Returns the file holding the job listing
+ * @param directory recording directory
+ * @return path to the file
+ */
+QString RecordingBackend::jobsFile(QString directory) {
+  return directory + "/qstat.txt";
+}
+
+/**
+ * @brief RecordingBackend::hostsFile Returns the file holding the host listing
+ * @param directory recording directory
+ * @return path to the file
+ */
+QString RecordingBackend::hostsFile(QString directory) {
+  return directory + "/qstat-f.xml";
+}
+
+/**
+ * @brief RecordingBackend::detailsIndexFile Returns the file listing each
+ * job detail document and the job numbers it was asked for
+ * @param directory recording directory
+ * @return path to the file
+ */
+QString RecordingBackend::detailsIndexFile(QString directory) {
+  return directory + "/details.idx";
+}
+
+/**
+ * @brief RecordingBackend::listJobs Lists the jobs and records the output
+ * @param queues queues running jobs are listed from, empty for all
+ * @param callback function called with the listing
+ */
+void RecordingBackend::listJobs(QStringList queues, Callback callback) {
+  QString filename = jobsFile(this->_mDirectory);
+  this->_mBackend->listJobs(
+      queues, [this, filename, callback](int exitCode, QByteArray output) {
+        this->_write(filename, output);
+        if (callback)
+          callback(exitCode, output);
+      });
+  return;
+}
+
+/**
+ * @brief RecordingBackend::hostStatus Lists every queue instance and records
+ * the document once it is complete
+ * @param dataCallback function called with each piece of xml output
+ * @param callback function called with the exit code
+ */
+void RecordingBackend::hostStatus(DataCallback dataCallback,
+                                  Callback callback) {
+  QSharedPointer<QByteArray> document(new QByteArray());
+  QString filename = hostsFile(this->_mDirectory);
+  this->_mBackend->hostStatus(
+      [document, dataCallback](QByteArray data) {
+        document->append(data);
+        if (dataCallback)
+          dataCallback(data);
+      },
+      [this, document, filename, callback](int exitCode, QByteArray output) {
+        document->append(output);
+        this->_write(filename, *document);
+        if (callback)
+          callback(exitCode, output);
+      });
+  return;
+}
+
+/**
+ * @brief RecordingBackend::jobDetails Asks for the details of a set of jobs
+ * and records the document once it is complete
+ * @param jobIds job numbers to ask for
+ * @param dataCallback function called with each piece of xml output
+ * @param callback function called with the exit code
+ */
+void RecordingBackend::jobDetails(QStringList jobIds,
+                                  DataCallback dataCallback,
+                                  Callback callback) {
+  QSharedPointer<QByteArray> document(new QByteArray());
+  QString name = QString("details-%1.xml").arg(++this->_mDetailsCount);
+
+  this->_mBackend->jobDetails(
+      jobIds,
+      [document, dataCallback](QByteArray data) {
+        document->append(data);
+        if (dataCallback)
+          dataCallback(data);
+      },
+      [this, document, name, jobIds, callback](int exitCode,
+                                                QByteArray output) {
+        document->append(output);
+        if (this->_write(this->_mDirectory + "/" + name, *document) == 0) {
+          QFile index(detailsIndexFile(this->_mDirectory));
+          if (index.open(QIODevice::WriteOnly | QIODevice::Append))
+            QTextStream(&index) << name << " " << jobIds.join(",") << "\n";
+        }
+        if (callback)
+          callback(exitCode, output);
+      });
+  return;
+}
+
+/**
+ * @brief RecordingBackend::isIdle Checks if the recorded backend is idle
+ * @return true if the backend is idle
+ */
+bool RecordingBackend::isIdle() { return this->_mBackend->isIdle(); }
+
+/**
+ * @brief RecordingBackend::maxProcesses Returns the maximum number of calls
+ * the recorded backend runs at once
+ * @return maximum number of calls
+ */
+int RecordingBackend::maxProcesses() { return this->_mBackend->maxProcesses(); }
+
+/**
+ * @brief RecordingBackend::setMaxProcesses Sets the maximum number of calls
+ * the recorded backend runs at once
+ * @param maxProcesses maximum number of calls
+ */
+void RecordingBackend::setMaxProcesses(int maxProcesses) {
+  this->_mBackend->setMaxProcesses(maxProcesses);
+  return;
+}
+
+/**
+ * @brief RecordingBackend::timeout Returns the time a call to the recorded
+ * backend may run before it is stopped
+ * @return time in milliseconds, 0 if calls are never stopped
+ */
+int RecordingBackend::timeout() { return this->_mBackend->timeout(); }
+
+/**
+ * @brief RecordingBackend::setTimeout Sets the time a call to the recorded
+ * backend may run before it is stopped
+ * @param msec time in milliseconds, 0 to never stop a call
+ */
+void RecordingBackend::setTimeout(int msec) {
+  this->_mBackend->setTimeout(msec);
+  return;
+}
+
+/**
+ * @brief RecordingBackend::cancel Stops every outstanding call to the
+ * recorded backend
+ */
+void RecordingBackend::cancel() {
+  this->_mBackend->cancel();
+  return;
+}
+
+/**
+ * @brief RecordingBackend::_write Replaces a file in the recording
+ * @param filename file to write
+ * @param data raw scheduler output
+ * @return status code
+ */
+int RecordingBackend::_write(QString filename, const QByteArray &data) {
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    QTextStream(stderr) << "Unable to record to " << filename << "\n";
+    return 1;
+  }
+  file.write(data);
+  return file.commit() ? 0 : 1;
+}
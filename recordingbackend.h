@@ -0,0 +1,70 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: recordingbackend.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef RECORDINGBACKEND_H
+#define RECORDINGBACKEND_H
+
+#include "schedulerbackend.h"
+#include <QString>
+
+class RecordingBackend : public SchedulerBackend {
+  Q_OBJECT
+public:
+  explicit RecordingBackend(SchedulerBackend *backend, QString directory,
+                            QObject *parent = nullptr);
+
+  static QString jobsFile(QString directory);
+  static QString hostsFile(QString directory);
+  static QString detailsIndexFile(QString directory);
+
+  void listJobs(QStringList queues, Callback callback);
+
+  void hostStatus(DataCallback dataCallback, Callback callback);
+
+  void jobDetails(QStringList jobIds, DataCallback dataCallback,
+                  Callback callback);
+
+  bool isIdle();
+
+  int maxProcesses();
+
+  void setMaxProcesses(int maxProcesses);
+
+  int timeout();
+
+  void setTimeout(int msec);
+
+  void cancel();
+
+private:
+  int _write(QString filename, const QByteArray &data);
+
+  /// Backend whose output is recorded
+  SchedulerBackend *_mBackend;
+
+  /// Directory the output is written to
+  QString _mDirectory;
+
+  /// Number of job detail documents written so far
+  int _mDetailsCount;
+};
+
+#endif // RECORDINGBACKEND_H
@@ -0,0 +1,293 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: replaybackend.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "replaybackend.h"
+#include "recordingbackend.h"
+#include <QFile>
+#include <QSet>
+#include <QTimer>
+
+/**
+ * @brief ReplayBackend::ReplayBackend Default constructor. Answers every call
+ * from a directory written by RecordingBackend instead of the scheduler
+ * @param parent Pointer to parent object
+ */
+ReplayBackend::ReplayBackend(QObject *parent) : SchedulerBackend(parent) {
+  this->_mLatency = 0;
+  this->_mMaxProcesses = 4;
+  this->_mTimeout = 0;
+  this->_mGeneration = 0;
+  this->_mCallCount = 0;
+}
+
+/**
+ * @brief ReplayBackend::load Reads a recording into memory
+ * @param directory recording directory
+ * @return status code
+ */
+int ReplayBackend::load(QString directory) {
+  QFile jobs(RecordingBackend::jobsFile(directory));
+  QFile hosts(RecordingBackend::hostsFile(directory));
+  if (!jobs.open(QIODevice::ReadOnly) || !hosts.open(QIODevice::ReadOnly))
+    return 1;
+  this->_mJobs = jobs.readAll();
+  this->_mHosts = hosts.readAll();
+
+  this->_mDetails.clear();
+  this->_mDetailsIndex.clear();
+  this->_mCallCount = 0;
+
+  //...Each index line names a document and the job numbers it
+  //   was asked for. Later documents replace earlier ones
+  QFile index(RecordingBackend::detailsIndexFile(directory));
+  if (!index.open(QIODevice::ReadOnly))
+    return 0;
+  while (!index.atEnd()) {
+    QList<QByteArray> line = index.readLine().trimmed().split(' ');
+    if (line.size() != 2)
+      continue;
+    QFile document(directory + "/" + QString(line[0]));
+    if (!document.open(QIODevice::ReadOnly))
+      continue;
+    this->_mDetails.push_back(document.readAll());
+    QList<QByteArray> ids = line[1].split(',');
+    for (int i = 0; i < ids.size(); i++)
+      this->_mDetailsIndex[ids[i].toInt()] = this->_mDetails.size() - 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief ReplayBackend::latency Returns the delay added to every call
+ * @return delay in milliseconds
+ */
+int ReplayBackend::latency() { return this->_mLatency; }
+
+/**
+ * @brief ReplayBackend::setLatency Sets the delay added to every call, used
+ * to imitate a slow qmaster
+ * @param msec delay in milliseconds
+ */
+void ReplayBackend::setLatency(int msec) {
+  this->_mLatency = msec < 0 ? 0 : msec;
+  return;
+}
+
+/**
+ * @brief ReplayBackend::callCount Returns the number of calls made since the
+ * recording was loaded, each standing in for one qstat process
+ * @return number of calls
+ */
+int ReplayBackend::callCount() { return this->_mCallCount; }
+
+/**
+ * @brief ReplayBackend::listJobs Answers with the recorded job listing,
+ * which was already limited to the queues when it was recorded
+ * @param queues queues running jobs are listed from, not used
+ * @param callback function called with the listing
+ */
+void ReplayBackend::listJobs(QStringList queues, Callback callback) {
+  Q_UNUSED(queues);
+  Call call;
+  call.documents.push_back(this->_mJobs);
+  call.exitCode = this->_mJobs.isEmpty() ? 1 : 0;
+  call.callback = callback;
+  this->_submit(call);
+  return;
+}
+
+/**
+ * @brief ReplayBackend::hostStatus Answers with the recorded host listing
+ * @param dataCallback function called with the xml document
+ * @param callback function called with the exit code
+ */
+void ReplayBackend::hostStatus(DataCallback dataCallback, Callback callback) {
+  Call call;
+  call.documents.push_back(this->_mHosts);
+  call.exitCode = this->_mHosts.isEmpty() ? 1 : 0;
+  call.dataCallback = dataCallback;
+  call.callback = callback;
+  this->_submit(call);
+  return;
+}
+
+/**
+ * @brief ReplayBackend::jobDetails Answers with every recorded document that
+ * describes one of the jobs. The batches do not need to match the ones
+ * recorded, so one call may return several documents
+ * @param jobIds job numbers to ask for
+ * @param dataCallback function called with each document
+ * @param callback function called with the exit code
+ */
+void ReplayBackend::jobDetails(QStringList jobIds, DataCallback dataCallback,
+                               Callback callback) {
+  QSet<int> used;
+  Call call;
+  call.exitCode = 0;
+  for (int i = 0; i < jobIds.size(); i++) {
+    QMap<int, int>::const_iterator it =
+        this->_mDetailsIndex.constFind(jobIds[i].toInt());
+    if (it == this->_mDetailsIndex.constEnd() || used.contains(it.value()))
+      continue;
+    used.insert(it.value());
+    call.documents.push_back(this->_mDetails[it.value()]);
+  }
+  call.dataCallback = dataCallback;
+  call.callback = callback;
+  this->_submit(call);
+  return;
+}
+
+/**
+ * @brief ReplayBackend::isIdle Checks if there is no call left to answer
+ * @return true if the backend is idle
+ */
+bool ReplayBackend::isIdle() {
+  return this->_mPending.isEmpty() && this->_mRunning.isEmpty();
+}
+
+/**
+ * @brief ReplayBackend::maxProcesses Returns the maximum number of calls
+ * answered at once
+ * @return maximum number of calls
+ */
+int ReplayBackend::maxProcesses() { return this->_mMaxProcesses; }
+
+/**
+ * @brief ReplayBackend::setMaxProcesses Sets the maximum number of calls
+ * answered at once, as with the number of qstat processes
+ * @param maxProcesses maximum number of calls
+ */
+void ReplayBackend::setMaxProcesses(int maxProcesses) {
+  this->_mMaxProcesses = maxProcesses < 1 ? 1 : maxProcesses;
+  this->_startNext();
+  return;
+}
+
+/**
+ * @brief ReplayBackend::timeout Returns the time a call may take before it
+ * is stopped
+ * @return time in milliseconds, 0 if calls are never stopped
+ */
+int ReplayBackend::timeout() { return this->_mTimeout; }
+
+/**
+ * @brief ReplayBackend::setTimeout Sets the time a call may take before it is
+ * stopped. A latency longer than this makes every call time out, as a
+ * stuck qmaster would
+ * @param msec time in milliseconds, 0 to never stop a call
+ */
+void ReplayBackend::setTimeout(int msec) {
+  this->_mTimeout = msec < 0 ? 0 : msec;
+  return;
+}
+
+/**
+ * @brief ReplayBackend::cancel Drops every call that has not been answered.
+ * Each callback is still called, with TimedOut
+ */
+void ReplayBackend::cancel() {
+  QQueue<Call> calls;
+  calls.swap(this->_mRunning);
+  calls.append(this->_mPending);
+  this->_mPending.clear();
+  this->_mGeneration++;
+
+  for (int i = 0; i < calls.size(); i++)
+    if (calls[i].callback)
+      calls[i].callback(TimedOut, QByteArray());
+
+  if (!calls.isEmpty() && this->isIdle())
+    emit idle();
+
+  return;
+}
+
+/**
+ * @brief ReplayBackend::_submit Queues a call to be answered
+ * @param call call to answer
+ */
+void ReplayBackend::_submit(const Call &call) {
+  this->_mCallCount++;
+  this->_mPending.enqueue(call);
+  this->_startNext();
+  return;
+}
+
+/**
+ * @brief ReplayBackend::_startNext Starts the latency timer of queued calls
+ * while there are free slots. Every call has the same latency, so they end
+ * in the order they were started
+ */
+void ReplayBackend::_startNext() {
+  int generation = this->_mGeneration;
+  int delay = this->_mLatency;
+
+  //...A call slower than the timeout ends at the timeout with
+  //   nothing to show for it
+  bool timedOut = this->_mTimeout > 0 && this->_mLatency > this->_mTimeout;
+  if (timedOut)
+    delay = this->_mTimeout;
+
+  while (!this->_mPending.isEmpty() &&
+         this->_mRunning.size() < this->_mMaxProcesses) {
+    Call call = this->_mPending.dequeue();
+    if (timedOut) {
+      call.documents.clear();
+      call.exitCode = TimedOut;
+    }
+    this->_mRunning.enqueue(call);
+    QTimer::singleShot(delay, this, [this, generation]() {
+      if (generation == this->_mGeneration)
+        this->_deliver();
+    });
+  }
+  return;
+}
+
+/**
+ * @brief ReplayBackend::_deliver Answers the oldest running call
+ */
+void ReplayBackend::_deliver() {
+  if (this->_mRunning.isEmpty())
+    return;
+
+  Call call = this->_mRunning.dequeue();
+  this->_startNext();
+
+  //...Streaming callers get each document separately so that
+  //   every document can be parsed on its own
+  QByteArray output;
+  if (call.dataCallback) {
+    for (int i = 0; i < call.documents.size(); i++)
+      call.dataCallback(call.documents[i]);
+  } else if (!call.documents.isEmpty())
+    output = call.documents.first();
+
+  if (call.callback)
+    call.callback(call.exitCode, output);
+
+  if (this->isIdle())
+    emit idle();
+
+  return;
+}
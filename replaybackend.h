@@ -0,0 +1,113 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: replaybackend.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef REPLAYBACKEND_H
+#define REPLAYBACKEND_H
+
+#include "schedulerbackend.h"
+#include <QByteArray>
+#include <QMap>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+
+class ReplayBackend : public SchedulerBackend {
+  Q_OBJECT
+public:
+  explicit ReplayBackend(QObject *parent = nullptr);
+
+  int load(QString directory);
+
+  int latency();
+
+  void setLatency(int msec);
+
+  int callCount();
+
+  void listJobs(QStringList queues, Callback callback);
+
+  void hostStatus(DataCallback dataCallback, Callback callback);
+
+  void jobDetails(QStringList jobIds, DataCallback dataCallback,
+                  Callback callback);
+
+  bool isIdle();
+
+  int maxProcesses();
+
+  void setMaxProcesses(int maxProcesses);
+
+  int timeout();
+
+  void setTimeout(int msec);
+
+  void cancel();
+
+private slots:
+  void _deliver();
+
+private:
+  /// A call waiting to be answered from the recording
+  struct Call {
+    QVector<QByteArray> documents;
+    int exitCode;
+    DataCallback dataCallback;
+    Callback callback;
+  };
+
+  void _submit(const Call &call);
+  void _startNext();
+
+  /// Recorded job listing
+  QByteArray _mJobs;
+
+  /// Recorded host listing
+  QByteArray _mHosts;
+
+  /// Recorded job detail documents
+  QVector<QByteArray> _mDetails;
+
+  /// Mapping from a job number to the last document that describes it
+  QMap<int, int> _mDetailsIndex;
+
+  /// Calls waiting for a free slot
+  QQueue<Call> _mPending;
+
+  /// Calls waiting for their latency to pass, in the order they end
+  QQueue<Call> _mRunning;
+
+  /// Delay added to every call in milliseconds
+  int _mLatency;
+
+  /// Maximum number of calls answered at once
+  int _mMaxProcesses;
+
+  /// Time a call may take before it is stopped in milliseconds, 0 for none
+  int _mTimeout;
+
+  /// Incremented on cancel so that timers for dropped calls do nothing
+  int _mGeneration;
+
+  /// Number of calls made since the recording was loaded
+  int _mCallCount;
+};
+
+#endif // REPLAYBACKEND_H
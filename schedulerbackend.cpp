@@ -0,0 +1,58 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: schedulerbackend.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "schedulerbackend.h"
+#include <QEventLoop>
+#include <QTimer>
+
+/**
+ * @brief SchedulerBackend::SchedulerBackend Default constructor
+ * @param parent Pointer to parent object
+ */
+SchedulerBackend::SchedulerBackend(QObject *parent) : QObject(parent) {}
+
+/**
+ * @brief SchedulerBackend::waitForFinished Runs an event loop until every
+ * call made to the backend, including any made from callbacks, has finished.
+ * Calls still outstanding when the time runs out are cancelled
+ * @param msec longest time to wait in milliseconds, -1 to wait forever
+ * @return true if every call finished in time
+ */
+bool SchedulerBackend::waitForFinished(int msec) {
+  if (this->isIdle())
+    return true;
+
+  QEventLoop loop;
+  QTimer timer;
+  connect(this, SIGNAL(idle()), &loop, SLOT(quit()));
+  if (msec >= 0) {
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+    timer.start(msec);
+  }
+  loop.exec();
+
+  if (this->isIdle())
+    return true;
+
+  this->cancel();
+  return false;
+}
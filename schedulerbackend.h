@@ -0,0 +1,68 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: schedulerbackend.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef SCHEDULERBACKEND_H
+#define SCHEDULERBACKEND_H
+
+#include "commandpool.h"
+#include <QObject>
+#include <QStringList>
+
+class SchedulerBackend : public QObject {
+  Q_OBJECT
+public:
+  /// Function called with the exit code and output of a scheduler call
+  typedef CommandPool::Callback Callback;
+
+  /// Function called with each piece of output as it arrives
+  typedef CommandPool::DataCallback DataCallback;
+
+  /// Exit code reported for a call that was stopped at its deadline
+  enum { TimedOut = CommandPool::TimedOut };
+
+  explicit SchedulerBackend(QObject *parent = nullptr);
+
+  virtual void listJobs(QStringList queues, Callback callback) = 0;
+
+  virtual void hostStatus(DataCallback dataCallback, Callback callback) = 0;
+
+  virtual void jobDetails(QStringList jobIds, DataCallback dataCallback,
+                          Callback callback) = 0;
+
+  virtual bool isIdle() = 0;
+
+  virtual int maxProcesses() = 0;
+
+  virtual void setMaxProcesses(int maxProcesses) = 0;
+
+  virtual int timeout() = 0;
+
+  virtual void setTimeout(int msec) = 0;
+
+  virtual void cancel() = 0;
+
+  bool waitForFinished(int msec = -1);
+
+signals:
+  void idle();
+};
+
+#endif // SCHEDULERBACKEND_H
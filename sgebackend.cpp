@@ -0,0 +1,153 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: sgebackend.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "sgebackend.h"
+#include <memory>
+
+/**
+ * @brief SgeBackend::SgeBackend Default constructor
+ * @param parent Pointer to parent object
+ */
+SgeBackend::SgeBackend(QObject *parent) : SchedulerBackend(parent) {
+  this->_mPool = new CommandPool(4, this);
+  connect(this->_mPool, SIGNAL(idle()), this, SIGNAL(idle()));
+}
+
+/**
+ * @brief SgeBackend::listJobs Runs qstat -r to list the jobs along with the
+ * queues they requested, so queued jobs can be filtered before their
+ * details are asked for. When queues are given, running jobs are only
+ * listed from their queue instances with qstat -q. Queued jobs are in no
+ * queue instance yet, so they are listed by a second qstat and the two
+ * listings are handed over as one
+ * @param queues queues running jobs are listed from, empty for all
+ * @param callback function called with the listing
+ */
+void SgeBackend::listJobs(QStringList queues, Callback callback) {
+  if (queues.isEmpty()) {
+    this->_mPool->submit("qstat -r", callback);
+    return;
+  }
+
+  //...Output of both calls, joined once the second one finishes
+  struct Listing {
+    int remaining;
+    int exitCode;
+    QByteArray running;
+    QByteArray pending;
+  };
+  std::shared_ptr<Listing> listing(new Listing());
+  listing->remaining = 2;
+  listing->exitCode = 0;
+
+  //...A timeout in either call marks the whole listing as cut off
+  auto finish = [listing, callback](int exitCode) {
+    if (exitCode != 0 && listing->exitCode != TimedOut)
+      listing->exitCode = exitCode;
+    if (--listing->remaining == 0 && callback)
+      callback(listing->exitCode, listing->running + listing->pending);
+  };
+
+  this->_mPool->submit("qstat -r -s rs -q " + queues.join(","),
+                       [listing, finish](int exitCode, QByteArray output) {
+                         listing->running = output;
+                         finish(exitCode);
+                       });
+  this->_mPool->submit("qstat -r -s p",
+                       [listing, finish](int exitCode, QByteArray output) {
+                         listing->pending = output;
+                         finish(exitCode);
+                       });
+  return;
+}
+
+/**
+ * @brief SgeBackend::hostStatus Runs qstat -f -xml to list every queue
+ * instance
+ * @param dataCallback function called with each piece of xml output
+ * @param callback function called with the exit code
+ */
+void SgeBackend::hostStatus(DataCallback dataCallback, Callback callback) {
+  this->_mPool->submit("qstat -f -xml", dataCallback, callback);
+  return;
+}
+
+/**
+ * @brief SgeBackend::jobDetails Runs qstat -xml -j for a set of jobs
+ * @param jobIds job numbers to ask for
+ * @param dataCallback function called with each piece of xml output
+ * @param callback function called with the exit code
+ */
+void SgeBackend::jobDetails(QStringList jobIds, DataCallback dataCallback,
+                            Callback callback) {
+  this->_mPool->submit("qstat -xml -j " + jobIds.join(","), dataCallback,
+                       callback);
+  return;
+}
+
+/**
+ * @brief SgeBackend::isIdle Checks if no qstat process is running or queued
+ * @return true if the backend is idle
+ */
+bool SgeBackend::isIdle() { return this->_mPool->isIdle(); }
+
+/**
+ * @brief SgeBackend::maxProcesses Returns the maximum number of qstat
+ * processes allowed to run at once
+ * @return maximum number of processes
+ */
+int SgeBackend::maxProcesses() { return this->_mPool->maxProcesses(); }
+
+/**
+ * @brief SgeBackend::setMaxProcesses Sets the maximum number of qstat
+ * processes allowed to run at once
+ * @param maxProcesses maximum number of processes
+ */
+void SgeBackend::setMaxProcesses(int maxProcesses) {
+  this->_mPool->setMaxProcesses(maxProcesses);
+  return;
+}
+
+/**
+ * @brief SgeBackend::timeout Returns the time a qstat process may run before
+ * it is killed
+ * @return time in milliseconds, 0 if processes are never killed
+ */
+int SgeBackend::timeout() { return this->_mPool->timeout(); }
+
+/**
+ * @brief SgeBackend::setTimeout Sets the time a qstat process may run before
+ * it is killed
+ * @param msec time in milliseconds, 0 to never kill a process
+ */
+void SgeBackend::setTimeout(int msec) {
+  this->_mPool->setTimeout(msec);
+  return;
+}
+
+/**
+ * @brief SgeBackend::cancel Kills every running qstat process and drops the
+ * queued ones
+ */
+void SgeBackend::cancel() {
+  this->_mPool->cancel();
+  return;
+}
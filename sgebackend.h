@@ -0,0 +1,57 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: sgebackend.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef SGEBACKEND_H
+#define SGEBACKEND_H
+
+#include "commandpool.h"
+#include "schedulerbackend.h"
+
+class SgeBackend : public SchedulerBackend {
+  Q_OBJECT
+public:
+  explicit SgeBackend(QObject *parent = nullptr);
+
+  void listJobs(QStringList queues, Callback callback);
+
+  void hostStatus(DataCallback dataCallback, Callback callback);
+
+  void jobDetails(QStringList jobIds, DataCallback dataCallback,
+                  Callback callback);
+
+  bool isIdle();
+
+  int maxProcesses();
+
+  void setMaxProcesses(int maxProcesses);
+
+  int timeout();
+
+  void setTimeout(int msec);
+
+  void cancel();
+
+private:
+  /// Pool used to run all scheduler commands
+  CommandPool *_mPool;
+};
+
+#endif // SGEBACKEND_H
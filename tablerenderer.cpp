@@ -0,0 +1,303 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: tablerenderer.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "tablerenderer.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+//...Color codes for unix terminal display
+static const char _cyan[] = "\E[36m";
+static const char _red[] = "\E[31m";
+static const char _green[] = "\E[32m";
+static const char _yellow[] = "\E[33m";
+static const char _magenta[] = "\E[35m";
+static const char _reset[] = "\E[0m";
+
+/// Border drawn above and below the job rows
+static const char _rule[] = "|------------------------------------------------"
+                            "--------------------------------|\n";
+
+/// Spaces used to pad the columns
+static const char _spaces[] = "                                ";
+
+/**
+ * @brief TableRenderer::TableRenderer Default constructor. Anything that
+ * does not change between rows is looked up once here
+ */
+TableRenderer::TableRenderer() {
+  this->_mUser = qgetenv("USER");
+  this->_mStatusText.resize(Qjob::SGE_STATUS_UNKNOWN + 1);
+}
+
+/**
+ * @brief TableRenderer::buffer Returns the output rendered so far
+ * @return rendered output
+ */
+const QByteArray &TableRenderer::buffer() const { return this->_mBuffer; }
+
+/**
+ * @brief TableRenderer::clear Drops the rendered output. The memory is kept
+ * for the next table
+ */
+void TableRenderer::clear() {
+  this->_mBuffer.resize(0);
+  return;
+}
+
+/**
+ * @brief TableRenderer::appendQueue Renders the job table and the health
+ * summary of one queue
+ * @param queue queue to render
+ * @param jobs jobs shown in the queue
+ */
+void TableRenderer::appendQueue(Queue *queue, const QVector<Qjob *> &jobs) {
+  QByteArray machine = queue->machine().toUtf8();
+  QByteArray queueName = queue->queueName().toUtf8();
+
+  this->_mBuffer.reserve(this->_mBuffer.size() + 1024 +
+                         jobs.size() * _maxRowLength);
+
+  this->_append("\n");
+  this->_append(_cyan);
+  this->_append("Machine:");
+  this->_append(_reset);
+  this->_append(" ");
+  this->_mBuffer.append(machine);
+  this->_append(" \n ");
+  this->_append(_cyan);
+  this->_append(" Queue:");
+  this->_append(_reset);
+  this->_append(" ");
+  this->_mBuffer.append(queueName);
+  this->_append("\n");
+
+  this->_append(_cyan);
+  this->_append(_rule);
+  this->_append(_cyan);
+  this->_append("|   JID    |            Job Name            |    User    |   "
+                "Status  |   Cores   |\n");
+  this->_append(_cyan);
+  this->_append(_rule);
+
+  int incomplete = 0;
+  for (int i = 0; i < jobs.size(); i++) {
+    this->appendJob(jobs[i]);
+    if (!jobs[i]->hasDetails())
+      incomplete++;
+  }
+
+  this->_append(_cyan);
+  this->_append(_rule);
+  this->_append("\n");
+  this->_append(_reset);
+  this->_append("SYSTEM STATUS\n");
+  this->_append("   RUNNING JOBS: ");
+  this->_appendNumber(jobs.size(), 0);
+  this->_append("\n\n");
+
+  this->_append("    TOTAL CORES: ");
+  this->_appendNumber(queue->queueTotalCores(), 0);
+  this->_append("\n    AVAIL CORES: ");
+  this->_appendNumber(queue->queueFreeCores(), 0);
+  this->_append("\n  RUNNING CORES: ");
+  this->_appendNumber(queue->queueRunningCores(), 0);
+  this->_append("\n\n    TOTAL NODES: ");
+  this->_appendNumber(queue->queueTotalNodes(), 0);
+  this->_append("\n       UP NODES: ");
+  this->_appendNumber(queue->queueUpNodes(), 0);
+  this->_append("\n     DOWN NODES: ");
+  this->_appendNumber(queue->queueDownNodes(), 0);
+  this->_append("\n     IDLE NODES: ");
+  this->_appendNumber(queue->queueIdleNodes(), 0);
+  this->_append("\n\n");
+
+  this->_append("Note: Jobs that fall between multiple queues are shown \n"
+                "in each queue they use resources from.\n");
+
+  if (incomplete > 0) {
+    this->_append(_red);
+    this->_append("Warning: ");
+    this->_appendNumber(incomplete, 0);
+    this->_append(" job(s) marked (incomplete) did not return their \n"
+                  "details before the deadline.\n");
+    this->_append(_reset);
+  }
+  return;
+}
+
+/**
+ * @brief TableRenderer::appendJob Renders one row of the job table. Columns
+ * are right aligned and cut to their width
+ * @param job job to render
+ */
+void TableRenderer::appendJob(const Qjob *job) {
+  QByteArray jobName = job->jobName().toUtf8();
+  QByteArray user = job->user().toUtf8();
+  const char *statusColor;
+
+  switch (job->status()) {
+  case Qjob::SGE_STATUS_RUNNING:
+    statusColor = _green;
+    break;
+  case Qjob::SGE_STATUS_PENDING:
+    statusColor = _yellow;
+    break;
+  case Qjob::SGE_STATUS_HELD:
+    statusColor = _magenta;
+    break;
+  case Qjob::SGE_STATUS_ERROR:
+    statusColor = _red;
+    break;
+  default:
+    statusColor = _reset;
+    break;
+  }
+
+  this->_append(_cyan);
+  this->_append("| ");
+  this->_append(_reset);
+  this->_appendNumber(job->jobNumber(), 7);
+  this->_append(_cyan);
+  this->_append("  | ");
+  //...A job whose details never arrived has no name to show
+  if (job->hasDetails()) {
+    this->_append(_reset);
+    this->_appendField(jobName.constData(), jobName.size(), 30);
+  } else {
+    this->_append(_red);
+    this->_appendField("(incomplete)", 12, 30);
+  }
+  this->_append(_cyan);
+  this->_append(" | ");
+  this->_append(user == this->_mUser ? _red : _reset);
+  this->_appendField(user.constData(), user.size(), 10);
+  this->_append(_cyan);
+  this->_append(" | ");
+  this->_append(statusColor);
+  const QByteArray &status = this->_statusText(job);
+  this->_appendField(status.constData(), status.size(), 9);
+  this->_append(_cyan);
+  this->_append(" | ");
+  this->_append(_reset);
+  this->_appendNumber(job->ncpu(), 9);
+  this->_append(_cyan);
+  this->_append(" | \n");
+  return;
+}
+
+/**
+ * @brief TableRenderer::write Writes the rendered output to standard output
+ * and clears it. The whole buffer is handed to the kernel at once, so a
+ * table normally costs a single write call
+ * @return status code
+ */
+int TableRenderer::write() {
+  const char *data = this->_mBuffer.constData();
+  qint64 remaining = this->_mBuffer.size();
+
+  //...Anything already written through stdio has to go first
+  fflush(stdout);
+
+  while (remaining > 0) {
+    ssize_t written = ::write(STDOUT_FILENO, data, size_t(remaining));
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      this->clear();
+      return 1;
+    }
+    data += written;
+    remaining -= written;
+  }
+
+  this->clear();
+  return 0;
+}
+
+/**
+ * @brief TableRenderer::_append Adds literal text to the buffer
+ * @param text null terminated text
+ */
+void TableRenderer::_append(const char *text) {
+  this->_mBuffer.append(text, int(strlen(text)));
+  return;
+}
+
+/**
+ * @brief TableRenderer::_appendField Adds text right aligned in a column,
+ * cut to the column width
+ * @param text text to add
+ * @param length length of the text
+ * @param width width of the column
+ */
+void TableRenderer::_appendField(const char *text, int length, int width) {
+  if (length > width)
+    length = width;
+  if (length < width)
+    this->_mBuffer.append(_spaces, width - length);
+  this->_mBuffer.append(text, length);
+  return;
+}
+
+/**
+ * @brief TableRenderer::_appendNumber Adds a number right aligned in a
+ * column, cut to the column width
+ * @param value number to add
+ * @param width width of the column, or 0 for no padding
+ */
+void TableRenderer::_appendNumber(qint64 value, int width) {
+  char digits[24];
+  char *end = digits + sizeof(digits);
+  char *p = end;
+  bool negative = value < 0;
+  quint64 magnitude = negative ? 0 - quint64(value) : quint64(value);
+
+  do {
+    *--p = char('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+  if (negative)
+    *--p = '-';
+
+  int length = int(end - p);
+  if (width == 0)
+    this->_mBuffer.append(p, length);
+  else
+    this->_appendField(p, length, width);
+  return;
+}
+
+/**
+ * @brief TableRenderer::_statusText Returns the status text of a job
+ * without converting it on every row
+ * @param job job to look at
+ * @return status text
+ */
+const QByteArray &TableRenderer::_statusText(const Qjob *job) {
+  int status = job->status();
+  if (status < 0 || status >= this->_mStatusText.size())
+    status = Qjob::SGE_STATUS_UNKNOWN;
+  if (this->_mStatusText[status].isEmpty())
+    this->_mStatusText[status] = job->statusString().toUtf8();
+  return this->_mStatusText[status];
+}
@@ -0,0 +1,66 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: tablerenderer.h
+//
+//------------------------------------------------------------------------------
+
+#ifndef TABLERENDERER_H
+#define TABLERENDERER_H
+
+#include "qjob.h"
+#include "queue.h"
+#include <QByteArray>
+#include <QVector>
+
+class TableRenderer {
+public:
+  TableRenderer();
+
+  void appendQueue(Queue *queue, const QVector<Qjob *> &jobs);
+
+  void appendJob(const Qjob *job);
+
+  const QByteArray &buffer() const;
+
+  void clear();
+
+  int write();
+
+private:
+  void _append(const char *text);
+  void _appendField(const char *text, int length, int width);
+  void _appendNumber(qint64 value, int width);
+  const QByteArray &_statusText(const Qjob *job);
+
+  /// Upper bound on the size of one job row, escape codes included
+  static const int _maxRowLength = 160;
+
+  /// Login name of the user, whose jobs are highlighted
+  QByteArray _mUser;
+
+  /// Status text for each status code, filled in when first seen
+  QVector<QByteArray> _mStatusText;
+
+  /// Rendered output waiting to be written
+  QByteArray _mBuffer;
+
+  TableRenderer(const TableRenderer &) = delete;
+  TableRenderer &operator=(const TableRenderer &) = delete;
+};
+
+#endif // TABLERENDERER_H
@@ -0,0 +1,123 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: hoststatusparsertest.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "hoststatusparser.h"
+#include "hosttable.h"
+#include "queue.h"
+#include "queueindex.h"
+#include <QtTest>
+
+/**
+ * @brief The HostStatusParserTest class Checks that queue instances are
+ * named and placed by their host, whatever the name of their queue
+ */
+class HostStatusParserTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void shortName();
+  void dottedQueueName();
+
+private:
+  static QByteArray _instance(const QString &name, int slotsUsed);
+};
+
+/**
+ * @brief HostStatusParserTest::_instance Builds a queue instance as
+ * qstat -f -xml writes it
+ * @param name name of the instance as queue@host.domain
+ * @param slotsUsed number of slots in use
+ * @return xml for one queue instance
+ */
+QByteArray HostStatusParserTest::_instance(const QString &name,
+                                           int slotsUsed) {
+  return QString("<Queue-List>\n"
+                 "<name>%1</name>\n"
+                 "<qtype>BIP</qtype>\n"
+                 "<slots_used>%2</slots_used>\n"
+                 "<slots_resv>0</slots_resv>\n"
+                 "<slots_total>24</slots_total>\n"
+                 "<load_avg>0.01</load_avg>\n"
+                 "</Queue-List>\n")
+      .arg(name)
+      .arg(slotsUsed)
+      .toUtf8();
+}
+
+/**
+ * @brief HostStatusParserTest::shortName Only the domain after the host is
+ * cut from an instance name
+ */
+void HostStatusParserTest::shortName() {
+  HostStatusParser::Instance instance;
+
+  instance.name = "long@d12chas001.crc.nd.edu";
+  QCOMPARE(instance.shortName(), QString("long@d12chas001"));
+
+  instance.name = "all.q@d12chas020.crc.nd.edu";
+  QCOMPARE(instance.shortName(), QString("all.q@d12chas020"));
+
+  instance.name = "all.q@d12chas020";
+  QCOMPARE(instance.shortName(), QString("all.q@d12chas020"));
+}
+
+/**
+ * @brief HostStatusParserTest::dottedQueueName Instances of a queue with a
+ * dot in its name, such as the default all.q, are kept apart by host and
+ * counted in the queues that own their hosts
+ */
+void HostStatusParserTest::dottedQueueName() {
+  Queue queue("Aegaeon", "@@westerink_d12chas", "d12chas", 1, 100, 24, 3);
+  QVector<Queue *> queues = QVector<Queue *>() << &queue;
+  QueueIndex index;
+  index.build(queues);
+  HostTable table(&index);
+
+  QStringList names;
+  HostStatusParser parser(
+      [&names, &table](const HostStatusParser::Instance &instance) {
+        names << instance.shortName();
+        table.setState(instance);
+      });
+  table.beginRefresh(queues);
+  parser.addData("<?xml version='1.0'?>\n<job_info>\n<queue_info>\n" +
+                 _instance("all.q@d12chas020.crc.nd.edu", 24) +
+                 _instance("all.q@d12chas021.crc.nd.edu", 0) +
+                 "</queue_info>\n</job_info>\n");
+
+  table.endRefresh();
+
+  QVERIFY(!parser.hasError());
+  QCOMPARE(names, QStringList() << "all.q@d12chas020"
+                                << "all.q@d12chas021");
+  for (int i = 0; i < names.size(); i++) {
+    QCOMPARE(index.queuesOnHost(names[i]).size(), 1);
+    QCOMPARE(index.queuesOnHost(names[i]).first(), &queue);
+  }
+
+  QCOMPARE(table.size(), 2);
+  QCOMPARE(queue.queueUpNodes(), 2);
+  QCOMPARE(queue.queueRunningNodes(), 1);
+  QCOMPARE(queue.queueIdleNodes(), 1);
+}
+
+QTEST_GUILESS_MAIN(HostStatusParserTest)
+#include "hoststatusparsertest.moc"
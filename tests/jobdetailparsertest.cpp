@@ -0,0 +1,112 @@
+//-----GPL----------------------------------------------------------------------
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//------------------------------------------------------------------------------
+//
+//  File: jobdetailparsertest.cpp
+//
+//------------------------------------------------------------------------------
+
+#include "jobcache.h"
+#include "jobdetailparser.h"
+#include "qjob.h"
+#include <QtTest>
+
+/**
+ * @brief The JobDetailParserTest class Checks that only job records read to
+ * their end are taken as complete
+ */
+class JobDetailParserTest : public QObject {
+  Q_OBJECT
+
+private slots:
+  void completeDocument();
+  void truncatedDocument();
+
+private:
+  static QByteArray _record(int jobNumber);
+};
+
+/**
+ * @brief JobDetailParserTest::_record Builds the detail record of a running
+ * job as qstat -xml -j writes it
+ * @param jobNumber job number of the record
+ * @return xml for one job
+ */
+QByteArray JobDetailParserTest::_record(int jobNumber) {
+  return QString("<element>\n"
+                 "<JB_job_number>%1</JB_job_number>\n"
+                 "<JB_job_name>job_%1</JB_job_name>\n"
+                 "<JB_hard_queue_list><QR_name>*long</QR_name>"
+                 "</JB_hard_queue_list>\n"
+                 "<JB_ja_tasks><ulong_sublist><JAT_task_list>\n"
+                 "<PET_id>1.d12chas001</PET_id>\n"
+                 "</JAT_task_list></ulong_sublist></JB_ja_tasks>\n"
+                 "</element>\n")
+      .arg(jobNumber)
+      .toUtf8();
+}
+
+/**
+ * @brief JobDetailParserTest::completeDocument Every job in a whole document
+ * has its details and is cached
+ */
+void JobDetailParserTest::completeDocument() {
+  Qjob first, second;
+  QMap<int, QVector<Qjob *> > jobMap;
+  jobMap[1].push_back(&first);
+  jobMap[2].push_back(&second);
+
+  JobDetailParser parser(&jobMap);
+  parser.addData("<?xml version='1.0'?>\n<detailed_job_info>\n<djob_info>\n" +
+                 _record(1) + _record(2) +
+                 "</djob_info>\n</detailed_job_info>\n");
+
+  QVERIFY(!parser.hasError());
+  QVERIFY(first.hasDetails());
+  QVERIFY(second.hasDetails());
+
+  JobCache cache;
+  cache.insert(&first);
+  cache.insert(&second);
+  QCOMPARE(cache.size(), 2);
+}
+
+/**
+ * @brief JobDetailParserTest::truncatedDocument A document cut off inside a
+ * record, as by a timeout, leaves that job without details and out of the
+ * cache, even though some of its fields were read
+ */
+void JobDetailParserTest::truncatedDocument() {
+  Qjob job;
+  QMap<int, QVector<Qjob *> > jobMap;
+  jobMap[1].push_back(&job);
+
+  QByteArray record = _record(1);
+  JobDetailParser parser(&jobMap);
+  parser.addData("<?xml version='1.0'?>\n<detailed_job_info>\n<djob_info>\n" +
+                 record.left(record.indexOf("<JB_ja_tasks>")));
+
+  QCOMPARE(parser.jobsParsed(), 1);
+  QCOMPARE(job.jobName(), QString("job_1"));
+  QVERIFY(!job.hasDetails());
+
+  JobCache cache;
+  cache.insert(&job);
+  QCOMPARE(cache.size(), 0);
+}
+
+QTEST_GUILESS_MAIN(JobDetailParserTest)
+#include "jobdetailparsertest.moc"
@@ -20,7 +20,9 @@
 //------------------------------------------------------------------------------
 
 #include "viewqueue.h"
+#include "qviewdaemon.h"
 #include <QTextStream>
+#include <QTimer>
 
 /**
  * @brief ViewQueue::ViewQueue Default constructor
@@ -28,16 +30,181 @@
  */
 ViewQueue::ViewQueue(QObject *parent) : QObject(parent) {
   this->_mQueueStat = new Qstat(this);
+  this->_mWatchInterval = 0;
+  this->_mShowAll = false;
+  this->_mExport = false;
+  this->_mFormat = JobExporter::FormatJson;
+}
+
+/**
+ * @brief ViewQueue::setMaxProcesses Sets the maximum number of qstat
+ * processes that may run at the same time
+ * @param maxProcesses maximum number of processes
+ */
+void ViewQueue::setMaxProcesses(int maxProcesses) {
+  this->_mQueueStat->setMaxProcesses(maxProcesses);
+}
+
+/**
+ * @brief ViewQueue::setTimeout Sets the time a single qstat call may take
+ * before it is killed
+ * @param msec time in milliseconds, 0 for no limit
+ */
+void ViewQueue::setTimeout(int msec) { this->_mQueueStat->setTimeout(msec); }
+
+/**
+ * @brief ViewQueue::setDeadline Sets the time a whole refresh may take
+ * before whatever has arrived is shown
+ * @param msec time in milliseconds, 0 for no limit
+ */
+void ViewQueue::setDeadline(int msec) {
+  this->_mQueueStat->setDeadline(msec);
+}
+
+/**
+ * @brief ViewQueue::setUseCache Sets if the on-disk job detail cache is used
+ * @param useCache true if the cache should be used
+ */
+void ViewQueue::setUseCache(bool useCache) {
+  this->_mQueueStat->setUseCache(useCache);
+}
+
+/**
+ * @brief ViewQueue::setBackend Sets the backend used to reach the scheduler
+ * @param backend backend to use, ownership is taken
+ */
+void ViewQueue::setBackend(SchedulerBackend *backend) {
+  this->_mQueueStat->setBackend(backend);
+}
+
+/**
+ * @brief ViewQueue::loadQueues Replaces the queues with the definitions in a
+ * file
+ * @param filename file to read
+ * @return status code
+ */
+int ViewQueue::loadQueues(QString filename) {
+  return this->_mQueueStat->loadQueues(filename);
+}
+
+/**
+ * @brief ViewQueue::setProfiler Sets the profiler that each collection is
+ * reported to
+ * @param profiler profiler to report to, or nullptr for none
+ */
+void ViewQueue::setProfiler(Profiler *profiler) {
+  this->_mQueueStat->setProfiler(profiler);
+}
+
+/**
+ * @brief ViewQueue::setHistory Sets the log that each refresh is appended to
+ * @param history log to append to, or nullptr for none
+ */
+void ViewQueue::setHistory(HistoryLog *history) {
+  this->_mQueueStat->setHistory(history);
+}
+
+/**
+ * @brief ViewQueue::setWatchInterval Sets the time between refreshes. When
+ * nonzero, the display is refreshed until the program is interrupted
+ * @param seconds seconds between refreshes
+ */
+void ViewQueue::setWatchInterval(int seconds) {
+  this->_mWatchInterval = seconds < 0 ? 0 : seconds;
+}
+
+/**
+ * @brief ViewQueue::setSocketName Sets the socket of a collector daemon. When
+ * a daemon is answering, its snapshot is displayed instead of querying the
+ * scheduler directly
+ * @param socketName path of the daemon socket, or empty to disable
+ */
+void ViewQueue::setSocketName(QString socketName) {
+  this->_mSocketName = socketName;
+}
+
+/**
+ * @brief ViewQueue::setShowAll Shows every queue without asking the user
+ * @param showAll true if every queue should be shown
+ */
+void ViewQueue::setShowAll(bool showAll) { this->_mShowAll = showAll; }
+
+/**
+ * @brief ViewQueue::setQueueName Shows the named queue without asking the
+ * user
+ * @param queueName name of the queue to show
+ */
+void ViewQueue::setQueueName(QString queueName) {
+  this->_mQueueName = queueName;
+}
+
+/**
+ * @brief ViewQueue::setFormat Sets the output format
+ * @param format table, json, ndjson or csv
+ * @return status code, nonzero if the format is unknown
+ */
+int ViewQueue::setFormat(QString format) {
+  if (format == "table") {
+    this->_mExport = false;
+    return 0;
+  }
+  if (!JobExporter::parseFormat(format, this->_mFormat))
+    return 1;
+  this->_mExport = true;
+  return 0;
 }
 
 /**
  * @brief ViewQueue::run Run the qview code
  */
 void ViewQueue::run() {
-  int index;
+  if (this->_selectQueues() != 0) {
+    emit ViewQueueError();
+    emit finished();
+    return;
+  }
+
+  if (this->_mWatchInterval > 0) {
+    this->_refresh();
+    return;
+  }
+
+  this->_update();
+  emit finished();
+
+  return;
+}
+
+/**
+ * @brief ViewQueue::_selectQueues Chooses the queues to show, either from
+ * the command line or by asking the user
+ * @return status code
+ */
+int ViewQueue::_selectQueues() {
+  int index = 0;
   QTextStream output(stdout);
   QTextStream input(stdin);
 
+  this->_mHashes.clear();
+
+  //...Machine readable output never asks, so it shows every
+  //   queue unless one was named
+  if (this->_mShowAll || (this->_mExport && this->_mQueueName.isEmpty())) {
+    for (int i = 0; i < this->_mQueueStat->numQueues(); i++)
+      this->_mHashes.push_back(this->_mQueueStat->queue(i)->hash());
+    return 0;
+  }
+
+  if (!this->_mQueueName.isEmpty()) {
+    Queue *q = this->_mQueueStat->queue(this->_mQueueName);
+    if (q == nullptr) {
+      QTextStream(stderr) << "Unknown queue: " << this->_mQueueName << "\n";
+      return 1;
+    }
+    this->_mHashes.push_back(q->hash());
+    return 0;
+  }
+
   output << "Select CRC Subsystem:\n";
   for (int i = 0; i < this->_mQueueStat->numQueues(); i++)
     output << "(" << i + 1 << ") " << this->_mQueueStat->queue(i)->machine()
@@ -46,8 +213,63 @@ void ViewQueue::run() {
   output.flush();
   input >> index;
 
-  this->_mQueueStat->run(this->_mQueueStat->queue(index - 1)->hash());
-  emit finished();
+  if (index < 1 || index > this->_mQueueStat->numQueues())
+    return 1;
+
+  this->_mHashes.push_back(this->_mQueueStat->queue(index - 1)->hash());
+  return 0;
+}
+
+/**
+ * @brief ViewQueue::_refresh Redraws the selected queue and schedules the
+ * next refresh. The Qstat object is kept so unchanged jobs are reused
+ */
+void ViewQueue::_refresh() {
+  if (!this->_mExport) {
+    QTextStream output(stdout);
+    output << "\E[2J\E[H";
+    output.flush();
+  }
+
+  this->_update();
+
+  //...Schedule after the run completes so slow refreshes never overlap
+  QTimer::singleShot(this->_mWatchInterval * 1000, this, SLOT(_refresh()));
+  return;
+}
+
+/**
+ * @brief ViewQueue::_update Displays the selected queues, using the collector
+ * daemon when one is running and falling back to direct collection. The
+ * scheduler is queried once no matter how many queues are shown
+ */
+void ViewQueue::_update() {
+  QVector<Queue *> queues;
+  for (int i = 0; i < this->_mQueueStat->numQueues(); i++)
+    if (this->_mHashes.contains(this->_mQueueStat->queue(i)->hash()))
+      queues.push_back(this->_mQueueStat->queue(i));
+
+  //...Jobs are exported as soon as their queues are known
+  JobExporter exporter(this->_mFormat, queues);
+  if (this->_mExport)
+    this->_mQueueStat->setJobCallback(
+        [&exporter](const Qjob &job) { exporter.addJob(job); });
+
+  int ierr = 0;
+  if (this->_mSocketName.isEmpty() ||
+      !QviewDaemon::fetchSnapshot(this->_mSocketName, this->_mQueueStat))
+    ierr = this->_mQueueStat->collect();
+
+  this->_mQueueStat->setJobCallback(Qstat::JobCallback());
+  if (ierr != 0)
+    return;
+
+  if (this->_mExport) {
+    exporter.finish();
+    return;
+  }
 
+  for (int i = 0; i < this->_mHashes.size(); i++)
+    this->_mQueueStat->display(this->_mHashes[i]);
   return;
 }
@@ -22,6 +22,7 @@
 #ifndef VIEWQUEUE_H
 #define VIEWQUEUE_H
 
+#include "jobexporter.h"
 #include "qstat.h"
 #include <QObject>
 
@@ -30,6 +31,32 @@ class ViewQueue : public QObject {
 public:
   explicit ViewQueue(QObject *parent = nullptr);
 
+  void setMaxProcesses(int maxProcesses);
+
+  void setTimeout(int msec);
+
+  void setDeadline(int msec);
+
+  void setUseCache(bool useCache);
+
+  void setBackend(SchedulerBackend *backend);
+
+  int loadQueues(QString filename);
+
+  void setProfiler(Profiler *profiler);
+
+  void setHistory(HistoryLog *history);
+
+  void setWatchInterval(int seconds);
+
+  void setSocketName(QString socketName);
+
+  void setShowAll(bool showAll);
+
+  void setQueueName(QString queueName);
+
+  int setFormat(QString format);
+
 signals:
   void finished();
   void ViewQueueError();
@@ -37,9 +64,36 @@ signals:
 public slots:
   void run();
 
+private slots:
+  void _refresh();
+
 private:
+  void _update();
+  int _selectQueues();
+
   /// Pointer to a qstat object
   Qstat *_mQueueStat;
+
+  /// Hashes of the queues selected by the user
+  QVector<QByteArray> _mHashes;
+
+  /// Logical value denoting if every queue is shown without asking
+  bool _mShowAll;
+
+  /// Name of the queue to show without asking, empty to ask
+  QString _mQueueName;
+
+  /// Seconds between refreshes in watch mode, 0 to run once
+  int _mWatchInterval;
+
+  /// Socket of a collector daemon to read from, empty to always collect
+  QString _mSocketName;
+
+  /// Logical value denoting if machine readable output is written
+  bool _mExport;
+
+  /// Machine readable format written instead of the tables
+  JobExporter::Format _mFormat;
 };
 
 #endif // VIEWQUEUE_H